@@ -12,3 +12,38 @@ endif
 ifneq (,$(realpath $(EXTENSION_DIR)/dom.so))
 PHP_TEST_SHARED_EXTENSIONS+=-d extension=$(EXTENSION_DIR)/dom.so
 endif
+
+# benchmarks, see bench/README.md
+BENCH_ARGS ?=
+BENCH_BASELINE ?= $(top_srcdir)/bench/baseline.json
+BENCH_PHP = $(PHP_EXECUTABLE) -n -d extension_dir=$(top_builddir)/modules $(PHP_TEST_SHARED_EXTENSIONS)
+
+# Comparing is the point of `make bench`, hence a missing baseline is an
+# error; pass BENCH_BASELINE= (empty) to just take measurements.
+bench: all
+	@if test -n "$(BENCH_BASELINE)" && test ! -r "$(BENCH_BASELINE)"; then \
+		echo "No benchmark baseline at $(BENCH_BASELINE), record one with 'make bench-baseline' first" >&2; \
+		exit 1; \
+	fi
+	$(BENCH_PHP) $(top_srcdir)/bench/run.php $(if $(BENCH_BASELINE),--baseline=$(BENCH_BASELINE)) --output=$(top_builddir)/bench_output.json $(BENCH_ARGS)
+
+bench-baseline: all
+	$(BENCH_PHP) $(top_srcdir)/bench/run.php --save-baseline=$(BENCH_BASELINE) $(BENCH_ARGS)
+
+.PHONY: bench bench-baseline
+
+# native microbenchmarks, linked against libphp (embed SAPI) and libv8
+BENCH_NATIVE_LIBS ?= -L$(prefix)/lib -lphp
+BENCH_NATIVE = $(top_builddir)/bench/native/v8js_microbench
+
+$(BENCH_NATIVE).lo: $(top_srcdir)/bench/native/v8js_microbench.cc
+	$(mkinstalldirs) $(top_builddir)/bench/native
+	$(LIBTOOL) --mode=compile $(CXX) -I. -I$(top_srcdir) $(INCLUDES) $(CXXFLAGS_CLEAN) $(EXTRA_CXXFLAGS) $(V8JS_BENCH_CXXFLAGS) -c $< -o $@
+
+$(BENCH_NATIVE): $(BENCH_NATIVE).lo $(shared_objects_v8js)
+	$(LIBTOOL) --mode=link $(CXX) $(LDFLAGS) -o $@ $(BENCH_NATIVE).lo $(shared_objects_v8js) $(V8JS_SHARED_LIBADD) $(BENCH_NATIVE_LIBS)
+
+bench-native: $(BENCH_NATIVE)
+	$(BENCH_NATIVE) $(BENCH_FILTER)
+
+.PHONY: bench-native
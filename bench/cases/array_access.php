@@ -0,0 +1,25 @@
+<?php
+/* ArrayAccess objects exported with v8js.use_array_access */
+
+ini_set('v8js.use_array_access', 1);
+
+$v8 = new V8Js();
+$v8->list = new ArrayObject(range(1, 100));
+ini_set('v8js.use_array_access', 0);
+
+$sum = $v8->executeString('(function () { var l = PHP.list, s = 0; for (var i = 0; i < l.length; i ++) { s += l[i]; } return s; })');
+$write = $v8->executeString('(function () { var l = PHP.list; for (var i = 0; i < l.length; i ++) { l[i] = i; } })');
+
+return [
+	'read_100' => function ($n) use ($sum) {
+		for ($i = 0; $i < $n; $i ++) {
+			$sum();
+		}
+	},
+
+	'write_100' => function ($n) use ($write) {
+		for ($i = 0; $i < $n; $i ++) {
+			$write();
+		}
+	},
+];
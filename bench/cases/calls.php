@@ -0,0 +1,46 @@
+<?php
+/* Calls across the boundary: JS->PHP callbacks (v8js_call_php_func) and PHP->JS calls */
+
+class BenchCallee {
+	public $value = 1;
+
+	function add($a, $b) {
+		return $a + $b;
+	}
+}
+
+$v8 = new V8Js();
+$v8->callee = new BenchCallee();
+$v8->closure = function ($a) { return $a; };
+
+$js_fn = $v8->executeString('(function (a, b) { return a + b; })');
+$js_obj = $v8->executeString('({ add: function (a, b) { return a + b; } })');
+$js_method_loop = $v8->executeString('(function (n) { var o = PHP.callee, s = 0; for (var i = 0; i < n; i ++) { s = o.add(s, i); } return s; })');
+$js_closure_loop = $v8->executeString('(function (n) { var f = PHP.closure, s = 0; for (var i = 0; i < n; i ++) { s += f(i); } return s; })');
+$js_property_loop = $v8->executeString('(function (n) { var o = PHP.callee, s = 0; for (var i = 0; i < n; i ++) { s += o.value; } return s; })');
+
+return [
+	'js_to_php/method' => function ($n) use ($js_method_loop) {
+		$js_method_loop($n);
+	},
+
+	'js_to_php/closure' => function ($n) use ($js_closure_loop) {
+		$js_closure_loop($n);
+	},
+
+	'js_to_php/property' => function ($n) use ($js_property_loop) {
+		$js_property_loop($n);
+	},
+
+	'php_to_js/function' => function ($n) use ($js_fn) {
+		for ($i = 0; $i < $n; $i ++) {
+			$js_fn($i, 1);
+		}
+	},
+
+	'php_to_js/method' => function ($n) use ($js_obj) {
+		for ($i = 0; $i < $n; $i ++) {
+			$js_obj->add($i, 1);
+		}
+	},
+];
@@ -0,0 +1,31 @@
+<?php
+/* Compilation: compile every time vs. executing a compiled script */
+
+$source = '';
+for ($i = 0; $i < 50; $i ++) {
+	$source .= "function f$i(a, b) { var r = []; for (var k in a) { r.push(a[k] + b * $i); } return r.join(','); }\n";
+}
+$source .= "f0({x: 1}, 2);\n";
+
+$v8 = new V8Js();
+$script = $v8->compileString($source, 'bench.js');
+
+return [
+	'execute_string' => function ($n) use ($v8, $source) {
+		for ($i = 0; $i < $n; $i ++) {
+			$v8->executeString($source, 'bench.js');
+		}
+	},
+
+	'compile_string' => function ($n) use ($v8, $source) {
+		for ($i = 0; $i < $n; $i ++) {
+			$v8->compileString($source, 'bench.js');
+		}
+	},
+
+	'execute_script' => function ($n) use ($v8, $script) {
+		for ($i = 0; $i < $n; $i ++) {
+			$v8->executeScript($script);
+		}
+	},
+];
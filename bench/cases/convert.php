@@ -0,0 +1,64 @@
+<?php
+/* Value conversion (zval_to_v8js, v8js_to_zval) for representative payloads */
+
+function bench_tree($depth, $width) {
+	if ($depth == 0) {
+		return ['leaf' => true, 'value' => 42.5, 'label' => 'node'];
+	}
+
+	$children = [];
+	for ($i = 0; $i < $width; $i ++) {
+		$children[] = bench_tree($depth - 1, $width);
+	}
+	return ['depth' => $depth, 'children' => $children];
+}
+
+$rows = [];
+for ($i = 0; $i < 100; $i ++) {
+	$rows[] = [
+		'id' => $i, 'name' => "row $i", 'email' => "user$i@example.org", 'active' => $i % 2 == 0,
+		'score' => $i * 1.5, 'created' => '2020-01-01 00:00:00', 'tags' => ['a', 'b'], 'parent' => null,
+	];
+}
+
+$assoc = [];
+for ($i = 0; $i < 100; $i ++) {
+	$assoc["key_$i"] = "value $i";
+}
+
+$payloads = [
+	'packed_1000' => range(1, 1000),
+	'assoc_100' => $assoc,
+	'rows_100x8' => $rows,
+	'tree_d6_w3' => bench_tree(6, 3),
+	'string_1m' => str_repeat('abcdefghijklmnopqrstuvwxyz01234', 32768),
+];
+
+$v8 = new V8Js();
+$sink = $v8->executeString('(function (x) { return 0; })');
+$v8->executeString('var payloads = {};');
+
+$cases = [];
+
+foreach ($payloads as $name => $payload) {
+	/* Store payload on JS side once, so php_to_js and js_to_php are measured separately */
+	$v8->payload = $payload;
+	$v8->executeString("payloads['$name'] = PHP.payload;");
+	$fetch = $v8->executeString("(function () { return payloads['$name']; })");
+
+	$cases["$name/php_to_js"] = function ($n) use ($sink, $payload) {
+		for ($i = 0; $i < $n; $i ++) {
+			$sink($payload);
+		}
+	};
+
+	$cases["$name/js_to_php"] = function ($n) use ($fetch) {
+		for ($i = 0; $i < $n; $i ++) {
+			$fetch();
+		}
+	};
+}
+
+unset($v8->payload);
+
+return $cases;
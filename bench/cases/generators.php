@@ -0,0 +1,27 @@
+<?php
+/* Generators in both directions */
+
+function bench_generator($count) {
+	for ($i = 0; $i < $count; $i ++) {
+		yield $i;
+	}
+}
+
+$v8 = new V8Js();
+$consume = $v8->executeString('(function (gen) { var s = 0; for (var x of gen) { s += x; } return s; })');
+$produce = $v8->executeString('(function* (count) { for (var i = 0; i < count; i ++) { yield i; } })');
+
+return [
+	'php_generator_in_js_100' => function ($n) use ($consume) {
+		for ($i = 0; $i < $n; $i ++) {
+			$consume(bench_generator(100));
+		}
+	},
+
+	'js_generator_in_php_100' => function ($n) use ($produce) {
+		for ($i = 0; $i < $n; $i ++) {
+			foreach ($produce(100) as $x) {
+			}
+		}
+	},
+];
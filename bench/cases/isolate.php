@@ -0,0 +1,19 @@
+<?php
+/* Isolate & context creation */
+
+return [
+	'create' => function ($n) {
+		for ($i = 0; $i < $n; $i ++) {
+			$v8 = new V8Js();
+			unset($v8);
+		}
+	},
+
+	'create_execute' => function ($n) {
+		for ($i = 0; $i < $n; $i ++) {
+			$v8 = new V8Js();
+			$v8->executeString('1');
+			unset($v8);
+		}
+	},
+];
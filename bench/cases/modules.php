@@ -0,0 +1,30 @@
+<?php
+/* CommonJS module loading via require() */
+
+$loader = function ($path) {
+	if (preg_match('/^mod(\d+)$/', $path, $m) && $m[1] > 0) {
+		return 'var next = require("./mod' . ($m[1] - 1) . '"); exports.value = next.value + 1;';
+	}
+	return 'exports.value = 0;';
+};
+
+$cached = new V8Js();
+$cached->setModuleLoader($loader);
+$cached->executeString('require("./mod10")');
+
+return [
+	'require_chain_10' => function ($n) use ($loader) {
+		for ($i = 0; $i < $n; $i ++) {
+			$v8 = new V8Js();
+			$v8->setModuleLoader($loader);
+			$v8->executeString('require("./mod10")');
+			unset($v8);
+		}
+	},
+
+	'require_cached' => function ($n) use ($cached) {
+		for ($i = 0; $i < $n; $i ++) {
+			$cached->executeString('require("./mod10")');
+		}
+	},
+];
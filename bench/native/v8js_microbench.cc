@@ -0,0 +1,371 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+/*
+ * Native microbenchmarks for V8Js' hot paths.
+ *
+ * This binary embeds PHP (embed SAPI), starts the v8js module and calls
+ * internal entry points directly in tight loops, without any PHP userland
+ * code in between.  Build & run with "make bench-native", see
+ * bench/README.md.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "php_v8js_macros.h"
+#include "v8js_commonjs.h"
+
+extern "C" {
+#include "sapi/embed/php_embed.h"
+}
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define V8JS_BENCH_PERF 1
+#endif
+
+#define V8JS_BENCH_SAMPLES		50
+#define V8JS_BENCH_SAMPLE_NS	2000000		/* 2ms per sample */
+
+/* {{{ perf_event counters */
+enum { BENCH_CYCLES, BENCH_INSTRUCTIONS, BENCH_CACHE_MISSES, BENCH_COUNTERS };
+
+struct bench_counters {
+	int fd[BENCH_COUNTERS];
+	unsigned long long value[BENCH_COUNTERS];
+};
+
+static void bench_counters_open(bench_counters *pc)
+{
+#ifdef V8JS_BENCH_PERF
+	static const unsigned long long config[BENCH_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+	};
+
+	for (int i = 0; i < BENCH_COUNTERS; i ++) {
+		struct perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		/* Might fail due to perf_event_paranoid or missing PMU (VMs) */
+		pc->fd[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+	}
+#else
+	for (int i = 0; i < BENCH_COUNTERS; i ++) {
+		pc->fd[i] = -1;
+	}
+#endif
+}
+
+static void bench_counters_start(bench_counters *pc)
+{
+#ifdef V8JS_BENCH_PERF
+	for (int i = 0; i < BENCH_COUNTERS; i ++) {
+		if (pc->fd[i] >= 0) {
+			ioctl(pc->fd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(pc->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+static void bench_counters_stop(bench_counters *pc)
+{
+	for (int i = 0; i < BENCH_COUNTERS; i ++) {
+		pc->value[i] = 0;
+#ifdef V8JS_BENCH_PERF
+		if (pc->fd[i] >= 0) {
+			ioctl(pc->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+			if (read(pc->fd[i], &pc->value[i], sizeof(pc->value[i])) != sizeof(pc->value[i])) {
+				pc->value[i] = 0;
+			}
+		}
+#endif
+	}
+}
+
+static void bench_counters_close(bench_counters *pc)
+{
+#ifdef V8JS_BENCH_PERF
+	for (int i = 0; i < BENCH_COUNTERS; i ++) {
+		if (pc->fd[i] >= 0) {
+			close(pc->fd[i]);
+		}
+	}
+#endif
+}
+/* }}} */
+
+/* {{{ Zend allocation counting
+ *
+ * Counts emalloc & friends by installing custom handlers on the Zend heap,
+ * which forward to the regular allocator.  V8's own (malloc based)
+ * allocations are not covered. */
+static unsigned long long bench_allocs;
+
+static void *bench_malloc(size_t size ZEND_FILE_LINE_DC ZEND_FILE_LINE_ORIG_DC)
+{
+	bench_allocs ++;
+	return zend_mm_alloc(zend_mm_get_heap(), size);
+}
+
+static void bench_free(void *ptr ZEND_FILE_LINE_DC ZEND_FILE_LINE_ORIG_DC)
+{
+	zend_mm_free(zend_mm_get_heap(), ptr);
+}
+
+static void *bench_realloc(void *ptr, size_t size ZEND_FILE_LINE_DC ZEND_FILE_LINE_ORIG_DC)
+{
+	bench_allocs ++;
+	return zend_mm_realloc(zend_mm_get_heap(), ptr, size);
+}
+/* }}} */
+
+struct bench_case {
+	const char *name;
+	std::function<void(size_t)> run;	/* perform n operations */
+};
+
+static unsigned long long bench_ns(std::function<void(size_t)> &fn, size_t n) /* {{{ */
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	fn(n);
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+/* }}} */
+
+static double bench_percentile(const std::vector<double> &sorted, double p) /* {{{ */
+{
+	size_t idx = static_cast<size_t>(p / 100 * (sorted.size() - 1) + 0.5);
+	return sorted[idx];
+}
+/* }}} */
+
+static void bench_run(bench_case &bc, const char *filter) /* {{{ */
+{
+	if (filter && !strstr(bc.name, filter)) {
+		return;
+	}
+
+	/* Warm up (lets V8 optimize, fills caches) and calibrate */
+	size_t n = 1;
+	unsigned long long elapsed;
+
+	while ((elapsed = bench_ns(bc.run, n)) < V8JS_BENCH_SAMPLE_NS / 4 && n < (1u << 24)) {
+		n *= 2;
+	}
+	n = std::max<size_t>(1, n * V8JS_BENCH_SAMPLE_NS / std::max<unsigned long long>(elapsed, 1));
+
+	std::vector<double> per_op;
+	bench_counters pc;
+	unsigned long long totals[BENCH_COUNTERS] = { 0 };
+
+	bench_counters_open(&pc);
+	bench_allocs = 0;
+	zend_mm_set_custom_handlers(zend_mm_get_heap(), bench_malloc, bench_free, bench_realloc);
+
+	for (int i = 0; i < V8JS_BENCH_SAMPLES; i ++) {
+		bench_counters_start(&pc);
+		elapsed = bench_ns(bc.run, n);
+		bench_counters_stop(&pc);
+
+		per_op.push_back(static_cast<double>(elapsed) / n);
+
+		for (int j = 0; j < BENCH_COUNTERS; j ++) {
+			totals[j] += pc.value[j];
+		}
+	}
+
+	zend_mm_set_custom_handlers(zend_mm_get_heap(), NULL, NULL, NULL);
+	bench_counters_close(&pc);
+
+	std::sort(per_op.begin(), per_op.end());
+
+	double ops = static_cast<double>(n) * V8JS_BENCH_SAMPLES;
+	printf("%-36s %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f %10.2f %8.2f\n", bc.name,
+		per_op.front(), bench_percentile(per_op, 50), bench_percentile(per_op, 90), bench_percentile(per_op, 99),
+		totals[BENCH_CYCLES] / ops, totals[BENCH_INSTRUCTIONS] / ops, totals[BENCH_CACHE_MISSES] / ops,
+		bench_allocs / ops);
+}
+/* }}} */
+
+static void bench_payload_packed(zval *zv, int count) /* {{{ */
+{
+	array_init_size(zv, count);
+	for (int i = 0; i < count; i ++) {
+		add_next_index_long(zv, i);
+	}
+}
+/* }}} */
+
+static void bench_payload_assoc(zval *zv, int count) /* {{{ */
+{
+	char key[32], value[32];
+
+	array_init_size(zv, count);
+	for (int i = 0; i < count; i ++) {
+		snprintf(key, sizeof(key), "key_%d", i);
+		snprintf(value, sizeof(value), "value %d", i);
+		add_assoc_string(zv, key, value);
+	}
+}
+/* }}} */
+
+static void bench_payload_rows(zval *zv, int count) /* {{{ */
+{
+	array_init_size(zv, count);
+	for (int i = 0; i < count; i ++) {
+		zval row;
+		array_init_size(&row, 8);
+		add_assoc_long(&row, "id", i);
+		add_assoc_string(&row, "name", (char *) "some name");
+		add_assoc_string(&row, "email", (char *) "user@example.org");
+		add_assoc_bool(&row, "active", i % 2);
+		add_assoc_double(&row, "score", i * 1.5);
+		add_assoc_string(&row, "created", (char *) "2020-01-01 00:00:00");
+		add_assoc_long(&row, "parent", i / 2);
+		add_assoc_null(&row, "deleted");
+		add_next_index_zval(zv, &row);
+	}
+}
+/* }}} */
+
+int main(int argc, char **argv) /* {{{ */
+{
+	const char *filter = argc > 1 ? argv[1] : NULL;
+	int status = 0;
+
+	PHP_EMBED_START_BLOCK(argc, argv)
+
+	/* Start v8js just like dl() would */
+	if (zend_startup_module(&v8js_module_entry) == FAILURE) {
+		fprintf(stderr, "failed to start v8js module\n");
+		status = 1;
+	}
+	else {
+		zval v8js;
+		zend_class_entry *ce = (zend_class_entry *) zend_hash_str_find_ptr(CG(class_table), ZEND_STRL("v8js"));
+
+		object_init_ex(&v8js, ce);
+		zend_call_method_with_0_params(Z_OBJ(v8js), ce, &ce->constructor, "__construct", NULL);
+
+		/* V8 scopes must be left before the V8Js instance (and its isolate) is freed */
+		{
+			v8js_ctx *c = Z_V8JS_CTX_OBJ_P(&v8js);
+			V8JS_CTX_PROLOGUE_EX(c, 1);
+
+			/* PHP payloads */
+			zval packed, assoc, rows, big_string;
+			bench_payload_packed(&packed, 1000);
+			bench_payload_assoc(&assoc, 100);
+			bench_payload_rows(&rows, 100);
+			ZVAL_STR(&big_string, zend_string_alloc(1 << 20, 0));
+			memset(Z_STRVAL(big_string), 'x', Z_STRLEN(big_string));
+			Z_STRVAL(big_string)[Z_STRLEN(big_string)] = '\0';
+
+			/* JS payloads */
+			v8::Local<v8::Value> js_packed = zval_to_v8js(&packed, isolate);
+			v8::Local<v8::Value> js_assoc = zval_to_v8js(&assoc, isolate);
+			v8::Local<v8::Value> js_rows = zval_to_v8js(&rows, isolate);
+			v8::Local<v8::Value> js_string = zval_to_v8js(&big_string, isolate);
+
+			std::function<void(size_t, zval *)> to_js = [isolate](size_t n, zval *value) {
+				for (size_t i = 0; i < n; i ++) {
+					v8::HandleScope scope(isolate);
+					zval_to_v8js(value, isolate);
+				}
+			};
+
+			std::function<void(size_t, v8::Local<v8::Value>, int)> to_zval = [isolate](size_t n, v8::Local<v8::Value> value, int flags) {
+				for (size_t i = 0; i < n; i ++) {
+					v8::HandleScope scope(isolate);
+					zval result;
+					v8js_to_zval(value, &result, flags, isolate);
+					zval_ptr_dtor(&result);
+				}
+			};
+
+			std::vector<bench_case> cases = {
+				{ "zval_to_v8js/packed_1000", [&](size_t n) { to_js(n, &packed); } },
+				{ "zval_to_v8js/assoc_100", [&](size_t n) { to_js(n, &assoc); } },
+				{ "zval_to_v8js/rows_100x8", [&](size_t n) { to_js(n, &rows); } },
+				{ "zval_to_v8js/string_1m", [&](size_t n) { to_js(n, &big_string); } },
+				{ "v8js_to_zval/packed_1000", [&](size_t n) { to_zval(n, js_packed, V8JS_FLAG_NONE); } },
+				{ "v8js_to_zval/assoc_100", [&](size_t n) { to_zval(n, js_assoc, V8JS_FLAG_FORCE_ARRAY); } },
+				{ "v8js_to_zval/rows_100x8", [&](size_t n) { to_zval(n, js_rows, V8JS_FLAG_FORCE_ARRAY); } },
+				{ "v8js_to_zval/string_1m", [&](size_t n) { to_zval(n, js_string, V8JS_FLAG_NONE); } },
+				{ "v8js_get_properties_hash/assoc_100", [&](size_t n) {
+					for (size_t i = 0; i < n; i ++) {
+						v8::HandleScope scope(isolate);
+						HashTable ht;
+						zend_hash_init(&ht, 0, NULL, ZVAL_PTR_DTOR, 0);
+						v8js_get_properties_hash(js_assoc, &ht, V8JS_FLAG_NONE, isolate);
+						zend_hash_destroy(&ht);
+					}
+				} },
+				{ "v8js_commonjs_normalise_identifier", [&](size_t n) {
+					char normalised_path[PATH_MAX], module_name[PATH_MAX];
+					for (size_t i = 0; i < n; i ++) {
+						v8js_commonjs_normalise_identifier("app/components/list", "../../lib/./util/format",
+							normalised_path, module_name);
+					}
+				} },
+			};
+
+			printf("%-36s %10s %10s %10s %10s %10s %10s %10s %8s\n", "kernel (per op)",
+				"min ns", "p50 ns", "p90 ns", "p99 ns", "cycles", "instr", "llc-miss", "allocs");
+
+			for (size_t i = 0; i < cases.size(); i ++) {
+				bench_run(cases[i], filter);
+			}
+
+			zval_ptr_dtor(&packed);
+			zval_ptr_dtor(&assoc);
+			zval_ptr_dtor(&rows);
+			zval_ptr_dtor(&big_string);
+		}
+
+		zval_ptr_dtor(&v8js);
+	}
+
+	PHP_EMBED_END_BLOCK()
+
+	return status;
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
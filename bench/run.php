@@ -0,0 +1,145 @@
+<?php
+/*
+ * V8Js benchmark runner
+ *
+ * Runs the benchmark cases from bench/cases/*.php, prints a summary table
+ * and optionally writes the results as JSON and/or compares them against
+ * a previously stored baseline.  See bench/README.md for details.
+ */
+
+if (!extension_loaded('v8js')) {
+	fwrite(STDERR, "v8js extension not loaded\n");
+	exit(2);
+}
+
+$opts = getopt('', [
+	'filter:', 'samples:', 'time:', 'output:', 'baseline:', 'save-baseline:', 'threshold:', 'fail-on-regression',
+]);
+
+$filter = isset($opts['filter']) ? '/' . str_replace('/', '\\/', $opts['filter']) . '/' : null;
+$samples = isset($opts['samples']) ? max(1, (int) $opts['samples']) : 7;
+$sampleTime = (isset($opts['time']) ? (float) $opts['time'] : 50) * 1e6;		/* ns per sample */
+$threshold = isset($opts['threshold']) ? (float) $opts['threshold'] : 10.0;
+
+/* Each case file returns an array of name => callable($n), where the callable
+ * performs $n operations of the benchmarked kind. */
+$cases = [];
+foreach (glob(__DIR__ . '/cases/*.php') as $file) {
+	$group = basename($file, '.php');
+	foreach (require $file as $name => $fn) {
+		$cases["$group/$name"] = $fn;
+	}
+}
+ksort($cases);
+
+function bench_measure(callable $fn, $n) {
+	$start = hrtime(true);
+	$fn($n);
+	return hrtime(true) - $start;
+}
+
+function bench_percentile(array $sorted, $p) {
+	$idx = ($p / 100) * (count($sorted) - 1);
+	$lo = (int) floor($idx);
+	$hi = (int) ceil($idx);
+	return $sorted[$lo] + ($sorted[$hi] - $sorted[$lo]) * ($idx - $lo);
+}
+
+$results = [];
+
+foreach ($cases as $name => $fn) {
+	if ($filter !== null && !preg_match($filter, $name)) {
+		continue;
+	}
+
+	/* Warm up & calibrate number of operations per sample */
+	$n = 1;
+	while (($elapsed = bench_measure($fn, $n)) < $sampleTime / 4 && $n < (1 << 24)) {
+		$n *= 2;
+	}
+	$n = max(1, (int) ($n * $sampleTime / max($elapsed, 1)));
+
+	$perOp = [];
+	for ($i = 0; $i < $samples; $i ++) {
+		gc_collect_cycles();
+		$perOp[] = bench_measure($fn, $n) / $n;
+	}
+	sort($perOp);
+
+	$results[$name] = [
+		'ops' => $n,
+		'samples' => $samples,
+		'min_ns' => round($perOp[0], 1),
+		'median_ns' => round(bench_percentile($perOp, 50), 1),
+		'p90_ns' => round(bench_percentile($perOp, 90), 1),
+		'max_ns' => round($perOp[count($perOp) - 1], 1),
+	];
+}
+
+$report = [
+	'meta' => [
+		'date' => date('c'),
+		'php' => PHP_VERSION,
+		'v8js' => phpversion('v8js'),
+		'v8' => V8Js::V8_VERSION,
+		'uname' => php_uname('s') . ' ' . php_uname('r') . ' ' . php_uname('m'),
+		'samples' => $samples,
+		'sample_time_ms' => $sampleTime / 1e6,
+	],
+	'results' => $results,
+];
+
+$baseline = null;
+if (isset($opts['baseline'])) {
+	if (!is_readable($opts['baseline'])) {
+		fwrite(STDERR, "Baseline {$opts['baseline']} not readable\n");
+		exit(2);
+	}
+
+	$baseline = json_decode(file_get_contents($opts['baseline']), true);
+
+	if (!isset($baseline['results'])) {
+		fwrite(STDERR, "Baseline {$opts['baseline']} is not a benchmark result file\n");
+		exit(2);
+	}
+}
+
+/* Summary table */
+$regressions = 0;
+printf("%-48s %12s %12s %12s%s\n", 'benchmark', 'median', 'min', 'p90', $baseline ? sprintf(' %12s %8s', 'baseline', 'delta') : '');
+
+foreach ($results as $name => $r) {
+	printf("%-48s %10.1fns %10.1fns %10.1fns", $name, $r['median_ns'], $r['min_ns'], $r['p90_ns']);
+
+	if ($baseline && isset($baseline['results'][$name])) {
+		$base = $baseline['results'][$name]['median_ns'];
+		$delta = $base > 0 ? ($r['median_ns'] - $base) / $base * 100 : 0;
+		$report['results'][$name]['baseline_median_ns'] = $base;
+		$report['results'][$name]['delta_pct'] = round($delta, 2);
+
+		printf(" %10.1fns %+7.1f%%", $base, $delta);
+
+		if ($delta > $threshold) {
+			echo "  REGRESSION";
+			$regressions ++;
+		}
+	}
+	echo "\n";
+}
+
+$json = json_encode($report, JSON_PRETTY_PRINT | JSON_UNESCAPED_SLASHES) . "\n";
+
+if (isset($opts['output'])) {
+	file_put_contents($opts['output'], $json);
+}
+
+if (isset($opts['save-baseline'])) {
+	file_put_contents($opts['save-baseline'], $json);
+	echo "Baseline written to {$opts['save-baseline']}\n";
+}
+
+if ($baseline) {
+	printf("%d benchmark(s) slower than baseline by more than %.1f%%\n", $regressions, $threshold);
+}
+
+exit(isset($opts['fail-on-regression']) && $regressions ? 1 : 0);
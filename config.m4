@@ -1,6 +1,9 @@
 PHP_ARG_WITH(v8js, for V8 Javascript Engine,
 [  --with-v8js           Include V8 JavaScript Engine])
 
+PHP_ARG_ENABLE(v8js-dtrace, whether to enable V8Js USDT probes,
+[  --enable-v8js-dtrace  V8Js: Add DTrace/SystemTap (sys/sdt.h) static probes], no, no)
+
 if test "$PHP_V8JS" != "no"; then
   SEARCH_PATH="/usr/local /usr"
   SEARCH_FOR="$PHP_LIBDIR/libv8.$SHLIB_SUFFIX_NAME"
@@ -200,20 +203,43 @@ int main ()
   PHP_ADD_INCLUDE($V8_DIR)
   PHP_NEW_EXTENSION(v8js, [	\
     v8js_array_access.cc	\
+    v8js_async.cc		\
+    v8js_batch_loader.cc	\
     v8js_class.cc			\
     v8js_commonjs.cc		\
+    v8js_console.cc			\
     v8js_convert.cc			\
+    v8js_dtrace.cc			\
+    v8js_encoding.cc		\
     v8js_exceptions.cc		\
     v8js_generator_export.cc	\
+    v8js_iterator_export.cc	\
     v8js_main.cc			\
+    v8js_memoize.cc		\
     v8js_methods.cc			\
+    v8js_metrics.cc		\
     v8js_object_export.cc	\
+    v8js_prewarm.cc		\
+    v8js_profiler.cc		\
 	v8js_timer.cc			\
+    v8js_tracing.cc		\
 	v8js_v8.cc				\
     v8js_v8object_class.cc	\
     v8js_variables.cc		\
   ], $ext_shared, , "$ac_cv_v8_narrowing -std="$ac_cv_v8_cstd)
 
+  if test "$PHP_V8JS_DTRACE" != "no"; then
+    AC_CHECK_HEADERS([sys/sdt.h], [
+      AC_DEFINE([HAVE_V8JS_DTRACE], 1, [Whether to compile in USDT probes])
+    ], [
+      AC_MSG_ERROR([Cannot find sys/sdt.h, which is required for USDT probes (install systemtap-sdt-dev)])
+    ])
+  fi
+
+  dnl flags for the native benchmark harness (make bench-native)
+  V8JS_BENCH_CXXFLAGS="$ac_cv_v8_narrowing -std=$ac_cv_v8_cstd"
+  PHP_SUBST(V8JS_BENCH_CXXFLAGS)
+
   PHP_ADD_MAKEFILE_FRAGMENT
 fi
 
@@ -27,6 +27,8 @@
 #include <list>
 #include <vector>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include <cmath>
 
@@ -73,6 +75,13 @@ extern "C" {
 #define V8JS_FLAG_NONE			(1<<0)
 #define V8JS_FLAG_FORCE_ARRAY	(1<<1)
 #define V8JS_FLAG_PROPAGATE_PHP_EXCEPTIONS	(1<<2)
+#define V8JS_FLAG_TYPED_ARRAYS	(1<<3)
+#define V8JS_FLAG_AWAIT			(1<<4)
+
+/* Element types for v8js_hash_to_typed_array() */
+#define V8JS_TYPED_ARRAY_ANY		0	/* Int32Array if all elements fit, Float64Array otherwise */
+#define V8JS_TYPED_ARRAY_INT32		1
+#define V8JS_TYPED_ARRAY_FLOAT64	2
 
 
 /* These are not defined by Zend */
@@ -84,12 +93,18 @@ extern "C" {
 /* Convert zval into V8 value */
 v8::Local<v8::Value> zval_to_v8js(zval *, v8::Isolate *);
 
+/* Hook opcache_reset() to invalidate the immutable array caches */
+void v8js_immutable_array_cache_init();
+
 /* Convert zend_long into V8 value */
 v8::Local<v8::Value> zend_long_to_v8js(zend_long, v8::Isolate *);
 
 /* Convert V8 value into zval */
 int v8js_to_zval(v8::Local<v8::Value>, zval *, int, v8::Isolate *);
 
+/* Convert packed array of ints/floats into TypedArray, empty if it isn't one */
+v8::MaybeLocal<v8::Value> v8js_hash_to_typed_array(HashTable *, int, v8::Isolate *);
+
 struct v8js_accessor_ctx
 {
 	zend_string *variable_name;
@@ -101,9 +116,29 @@ void v8js_accessor_ctx_dtor(v8js_accessor_ctx *);
 /* Register accessors into passed object */
 void v8js_register_accessors(std::vector<v8js_accessor_ctx*> *accessor_list, v8::Local<v8::FunctionTemplate>, zval *, v8::Isolate *);
 
+/* Modes of V8Js::bindGlobals() */
+#define V8JS_BIND_COPY			0	/* convert once */
+#define V8JS_BIND_REFERENCE		1	/* convert the referenced value on every read */
+#define V8JS_BIND_TRACKED		2	/* convert again only if PHP changed the value */
+
+struct v8js_global_binding
+{
+	int mode;
+	zend_reference *ref;
+	zval snapshot; /* value last converted (tracked mode) */
+	v8::Persistent<v8::Value> cached;
+};
+
+void v8js_global_binding_dtor(v8js_global_binding *);
+
+/* Bind values of passed array on the global object, returns false (with
+ * exception thrown) on error */
+bool v8js_bind_globals(v8js_ctx *c, HashTable *values, int mode, v8::Isolate *);
+
 
 /* Forward declarations */
 struct v8js_timer_ctx;
+struct v8js_prewarmed;
 
 /* Module globals */
 ZEND_BEGIN_MODULE_GLOBALS(v8js)
@@ -113,6 +148,14 @@ ZEND_BEGIN_MODULE_GLOBALS(v8js)
   /* Ini globals */
   bool use_date; /* Generate JS Date objects instead of PHP DateTime */
   bool use_array_access; /* Convert ArrayAccess, Countable objects to array-like objects */
+  bool enum_as_value; /* Convert backed enum cases to their value */
+  bool immutable_array_cache; /* Convert immutable arrays once, hand out frozen copies */
+  uint32_t immutable_array_generation; /* Bumped by opcache_reset(), invalidates the caches */
+  int console_level; /* Minimum level of console messages to keep */
+  long console_buffer_size; /* Maximum number of buffered console messages */
+  long memoize_cache_size; /* Maximum number of memoized call results per instance */
+  bool profile_callbacks; /* Collect timing statistics of JS->PHP callbacks */
+  long slowlog_threshold; /* Log JS stack of executions running longer (ms) */
 
   // Timer thread globals
   std::deque<v8js_timer_ctx *> timer_stack;
@@ -121,6 +164,23 @@ ZEND_BEGIN_MODULE_GLOBALS(v8js)
   bool timer_stop;
 
   bool fatal_error_abort;
+
+  bool in_async_fiber; /* Running the Fiber of an async callback, see v8js_async.cc */
+
+  bool tracing_started; /* V8Js::startTracing() was called by this request */
+
+  /* Pending metrics, see v8js_metrics_flush() */
+  uint64_t metrics_callbacks;
+  uint64_t metrics_conversion_bytes;
+
+  /* Export plans of V8Js subclasses, per request as user classes are */
+  std::unordered_map<zend_class_entry *, v8js_export_plan> export_plans;
+
+  /* Pre-warmed isolates, see v8js_prewarm.cc */
+  std::vector<v8js_prewarmed *> prewarm_pool;
+  bool prewarm_done; /* v8js.prewarm_count was handled by first RINIT */
+  zend_string *prewarm_snapshot_data;
+  v8::StartupData prewarm_snapshot;
 ZEND_END_MODULE_GLOBALS(v8js)
 
 extern zend_v8js_globals v8js_globals;
@@ -0,0 +1,62 @@
+--TEST--
+Test V8Js::async() : Fiber-backed callbacks returning promises
+--SKIPIF--
+<?php
+require_once(dirname(__FILE__) . '/skipif.inc');
+if (PHP_VERSION_ID < 80100) die('SKIP Fibers require PHP 8.1');
+?>
+--FILE--
+<?php
+
+$v8 = new V8Js();
+
+$v8->work = $v8->async(function ($name, $steps) {
+	for ($i = 0; $i < $steps; $i ++) {
+		echo "$name step $i\n";
+		Fiber::suspend();
+	}
+	return "$name done";
+});
+
+$v8->fail = $v8->async(function () {
+	Fiber::suspend();
+	throw new Exception('failed');
+});
+
+var_dump($v8->executeString('
+	var p = PHP.work("a", 1);
+	p instanceof Promise;
+'));
+
+var_dump($v8->executeString('
+	Promise.all([PHP.work("b", 2), PHP.work("c", 1)]);
+', '', V8Js::FLAG_AWAIT));
+
+var_dump($v8->executeString('
+	PHP.fail().catch(e => "caught " + e.getMessage());
+', '', V8Js::FLAG_AWAIT | V8Js::FLAG_PROPAGATE_PHP_EXCEPTIONS));
+
+try {
+	$v8->executeString('
+		(async () => { throw new Error("rejected"); })();
+	', '', V8Js::FLAG_AWAIT);
+} catch (V8JsScriptException $e) {
+	var_dump(strpos($e->getMessage(), 'Error: rejected') !== false);
+}
+?>
+===EOF===
+--EXPECT--
+a step 0
+bool(true)
+b step 0
+c step 0
+b step 1
+array(2) {
+  [0]=>
+  string(6) "b done"
+  [1]=>
+  string(6) "c done"
+}
+string(13) "caught failed"
+bool(true)
+===EOF===
@@ -0,0 +1,48 @@
+--TEST--
+Test V8Js::async() : Pending calls are cancelled when execution is aborted
+--SKIPIF--
+<?php
+require_once(dirname(__FILE__) . '/skipif.inc');
+if (PHP_VERSION_ID < 80100) die('SKIP Fibers require PHP 8.1');
+?>
+--FILE--
+<?php
+
+$v8 = new V8Js();
+
+$v8->slow = $v8->async(function ($name) {
+	try {
+		while (true) {
+			Fiber::suspend();
+		}
+	} finally {
+		echo "$name unwound\n";
+	}
+});
+
+try {
+	$v8->executeString('PHP.slow("a")', '', 0, 200);
+} catch (V8JsTimeLimitException $e) {
+	echo "time limit\n";
+}
+
+// Doesn't resume the call of the aborted script
+var_dump($v8->executeString('1 + 1'));
+
+try {
+	$v8->executeString('PHP.slow("b"); throw new Error("failed")');
+} catch (V8JsScriptException $e) {
+	echo "script exception\n";
+}
+
+var_dump($v8->executeString('2 + 2'));
+?>
+===EOF===
+--EXPECT--
+a unwound
+time limit
+int(2)
+b unwound
+script exception
+int(4)
+===EOF===
@@ -0,0 +1,49 @@
+--TEST--
+Test V8Js::setAsyncWait() : Blocking while suspended, no V8 calls from Fibers
+--SKIPIF--
+<?php
+require_once(dirname(__FILE__) . '/skipif.inc');
+if (PHP_VERSION_ID < 80100) die('SKIP Fibers require PHP 8.1');
+?>
+--FILE--
+<?php
+
+$v8 = new V8Js();
+
+$v8->setAsyncWait(function ($pending) {
+	echo "wait $pending\n";
+});
+
+$v8->work = $v8->async(function ($steps) {
+	for ($i = 0; $i < $steps; $i ++) {
+		Fiber::suspend();
+	}
+	return "done $steps";
+});
+
+// Waits after the first round only, then every round completes a call
+var_dump($v8->executeString('Promise.all([PHP.work(1), PHP.work(2)])', '', V8Js::FLAG_AWAIT));
+
+$v8->setAsyncWait(null);
+
+$v8->each = $v8->async(function ($fn) {
+	try {
+		return $fn(1);
+	} catch (V8JsException $e) {
+		return $e->getMessage();
+	}
+});
+
+var_dump($v8->executeString('PHP.each(x => x + 1)', '', V8Js::FLAG_AWAIT));
+?>
+===EOF===
+--EXPECT--
+wait 2
+array(2) {
+  [0]=>
+  string(6) "done 1"
+  [1]=>
+  string(6) "done 2"
+}
+string(55) "Cannot call into V8 from the Fiber of an async callback"
+===EOF===
@@ -0,0 +1,53 @@
+--TEST--
+Test V8Js::registerBatchLoader() : keys of one tick are loaded in one call
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+
+$v8 = new V8Js();
+
+$v8->registerBatchLoader('loadUser', function (array $ids) {
+	echo 'loading ', implode(',', $ids), "\n";
+	$users = [];
+	foreach ($ids as $id) {
+		if ($id !== 3) {
+			$users[$id] = "user$id";
+		}
+	}
+	return $users;
+});
+
+$v8->registerBatchLoader('broken', function (array $keys) {
+	return 'nope';
+});
+
+var_dump($v8->executeString('
+	Promise.all([1, 2, 1, "2", 3].map(id => loadUser(id)))
+		.then(users => loadUser(4).then(user => users.concat([user])));
+', '', V8Js::FLAG_AWAIT));
+
+var_dump($v8->executeString('
+	broken("x").catch(e => e instanceof TypeError);
+', '', V8Js::FLAG_AWAIT));
+?>
+===EOF===
+--EXPECT--
+loading 1,2,3
+loading 4
+array(6) {
+  [0]=>
+  string(5) "user1"
+  [1]=>
+  string(5) "user2"
+  [2]=>
+  string(5) "user1"
+  [3]=>
+  string(5) "user2"
+  [4]=>
+  NULL
+  [5]=>
+  string(5) "user4"
+}
+bool(true)
+===EOF===
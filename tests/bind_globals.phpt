@@ -0,0 +1,59 @@
+--TEST--
+Test V8Js::bindGlobals() : Copy, reference and change-tracked bindings
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$copy = 'old';
+$ref = 1;
+$tracked = ['a' => 1];
+
+$v8 = new V8Js();
+$v8->bindGlobals(['copy' => $copy]);
+$v8->bindGlobals(['ref' => &$ref], V8Js::BIND_REFERENCE);
+$v8->bindGlobals(['tracked' => &$tracked], V8Js::BIND_TRACKED);
+
+$v8->executeString('var first = tracked;');
+$copy = 'new';
+$ref = 2;
+var_dump($v8->executeString('[copy, ref, tracked === first].join()'));
+
+$tracked['a'] = 2;
+var_dump($v8->executeString('[tracked === first, tracked.a].join()'));
+
+try {
+	$v8->bindGlobals(['x' => 1], V8Js::BIND_TRACKED);
+} catch (V8JsException $e) {
+	var_dump($e->getMessage());
+}
+
+class Tracer {
+	public function __destruct() { echo "released\n"; }
+}
+
+// Rebinding a name releases the previous binding
+$first = new Tracer();
+$second = 1;
+$v8->bindGlobals(['traced' => &$first], V8Js::BIND_REFERENCE);
+$v8->bindGlobals(['traced' => &$second], V8Js::BIND_REFERENCE);
+unset($first);
+var_dump($v8->executeString('traced'));
+
+// Nothing is bound if any of the entries is invalid
+try {
+	$v8->bindGlobals(['valid' => &$second, 0 => 1], V8Js::BIND_REFERENCE);
+} catch (V8JsException $e) {
+	var_dump($e->getMessage());
+}
+var_dump($v8->executeString('typeof valid'));
+?>
+===EOF===
+--EXPECT--
+string(10) "old,2,true"
+string(7) "false,2"
+string(46) "Global binding 'x' must be passed by reference"
+released
+int(1)
+string(36) "Global binding names must be strings"
+string(9) "undefined"
+===EOF===
@@ -0,0 +1,51 @@
+--TEST--
+Test V8Js::getCallbackProfile() : counts JS->PHP callbacks
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--INI--
+v8js.profile_callbacks=1
+--FILE--
+<?php
+class Foo {
+	public $bar = 23;
+
+	function add($a, $b) {
+		return $a + $b;
+	}
+}
+
+$v8 = new V8Js();
+$v8->foo = new Foo();
+$v8->executeString(<<<EOJS
+for (var i = 0; i < 5; i ++) {
+	PHP.foo.add(i, PHP.foo.bar);
+}
+PHP.foo.bar = 42;
+EOJS
+);
+
+$profile = $v8->getCallbackProfile(0, true);
+usort($profile, function ($a, $b) { return strcmp($a['name'], $b['name']); });
+
+foreach ($profile as $entry) {
+	var_dump($entry['name'], $entry['calls'], array_sum($entry['histogram']) === $entry['calls'], $entry['max_us'] >= $entry['avg_us']);
+}
+
+var_dump(count($v8->getCallbackProfile()));
+?>
+===EOF===
+--EXPECT--
+string(8) "Foo->bar"
+int(5)
+bool(true)
+bool(true)
+string(9) "Foo->bar="
+int(1)
+bool(true)
+bool(true)
+string(8) "Foo::add"
+int(5)
+bool(true)
+bool(true)
+int(0)
+===EOF===
@@ -0,0 +1,54 @@
+--TEST--
+Test V8Js::createCodeCache() : consume cache of executed script
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--INI--
+v8js.metrics=1
+--FILE--
+<?php
+$JS = <<< EOT
+function square(x) { return x * x; }
+function unused() { return 42; }
+square(7);
+EOT;
+
+$v8 = new V8Js();
+$script = $v8->compileString($JS, 'cache.js');
+var_dump($v8->executeScript($script));
+
+$cache = $v8->createCodeCache($script);
+var_dump(is_string($cache) && strlen($cache) > 0);
+
+$warm = $v8->createWarmCodeCache($JS, 'cache.js', ['unused()']);
+var_dump(is_string($warm) && strlen($warm) > 0);
+
+$before = v8js_metrics();
+
+$v8b = new V8Js();
+$script = $v8b->compileString($JS, 'cache.js', $cache);
+var_dump($v8b->executeScript($script));
+
+$script = $v8b->compileString("'other source'", 'cache.js', $cache);
+var_dump($v8b->executeScript($script));
+
+$after = v8js_metrics();
+var_dump($after['code_cache_hits'] - $before['code_cache_hits']);
+var_dump($after['code_cache_rejects'] - $before['code_cache_rejects']);
+
+try {
+	$v8b->createCodeCache($v8->compileString('1'));
+} catch (Exception $e) {
+}
+?>
+===EOF===
+--EXPECTF--
+int(49)
+bool(true)
+bool(true)
+int(49)
+string(12) "other source"
+int(1)
+int(1)
+
+Warning: Script resource from wrong V8Js object passed in %s on line %d
+===EOF===
@@ -0,0 +1,33 @@
+--TEST--
+Test V8Js::drainConsole() : console output is buffered and formatted
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->executeString(<<<EOJS
+console.log("Hello %s, %d items", "world", 42.7);
+console.info({ a: 1 }, [1, 2], "plain");
+console.debug("filtered by default");
+console.error("100%% sure", 3, "%s");
+console.warn("%o %c%f", "str", "color: red", 1.5);
+console.log();
+EOJS
+);
+
+foreach ($v8->drainConsole() as $line) {
+	echo $line['level'], ': ', $line['message'], "\n";
+}
+
+var_dump($v8->drainConsole());
+?>
+===EOF===
+--EXPECT--
+log: Hello world, 42 items
+info: {"a":1} [1,2] plain
+error: 100% sure 3 %s
+warn: "str" 1.5
+log: 
+array(0) {
+}
+===EOF===
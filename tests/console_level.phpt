@@ -0,0 +1,29 @@
+--TEST--
+Test V8Js::drainConsole() : console level and buffer size
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--INI--
+v8js.console_level=warn
+v8js.console_buffer_size=2
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->executeString(<<<EOJS
+for (var i = 1; i <= 4; i ++) {
+	console.warn("warning", i);
+	console.info("info", i);
+}
+console.error(new Error("boom").message);
+EOJS
+);
+
+foreach ($v8->drainConsole() as $line) {
+	echo $line['level'], ': ', $line['message'], "\n";
+}
+?>
+===EOF===
+--EXPECT--
+warn: 3 console message(s) dropped, buffer size exceeded
+warn: warning 4
+error: boom
+===EOF===
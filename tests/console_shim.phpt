@@ -0,0 +1,39 @@
+--TEST--
+Test V8Js::drainConsole() : Shims installed only if console is undefined
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$shim = <<<EOJS
+if (typeof console === 'undefined') {
+	console = { log: function (msg) { print('shim: ' + msg + "\\n"); } };
+}
+console.log('hello');
+EOJS;
+
+// console is defined natively, the shim is skipped and output buffered
+$v8 = new V8Js();
+$v8->executeString($shim);
+var_dump($v8->drainConsole());
+
+// v8js.console=0 restores the previous behaviour
+ini_set('v8js.console', 0);
+$v8 = new V8Js();
+$v8->executeString($shim);
+var_dump($v8->drainConsole());
+?>
+===EOF===
+--EXPECT--
+array(1) {
+  [0]=>
+  array(2) {
+    ["level"]=>
+    string(3) "log"
+    ["message"]=>
+    string(5) "hello"
+  }
+}
+shim: hello
+array(0) {
+}
+===EOF===
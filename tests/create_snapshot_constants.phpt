@@ -0,0 +1,33 @@
+--TEST--
+Test V8Js::createSnapshot() : Constants are embedded frozen
+--SKIPIF--
+<?php
+require_once(dirname(__FILE__) . '/skipif.inc');
+
+if (!method_exists('V8Js', 'createSnapshot')) {
+    die('SKIP V8Js::createSnapshot not supported');
+}
+?>
+--FILE--
+<?php
+$snap = V8Js::createSnapshot('var greeting = CONFIG.greeting + " " + CONFIG.names[0];', [
+	'CONFIG' => ['greeting' => 'Hello', 'names' => ['World']],
+]);
+
+$v8 = new V8Js('PHP', array(), $snap);
+var_dump($v8->executeString('
+	"use strict";
+	var frozen;
+	try { CONFIG.names.push("x"); frozen = false; } catch (e) { frozen = true; }
+	[greeting, frozen, Object.isFrozen(CONFIG)].join()
+'));
+
+var_dump(V8Js::createSnapshot('var x = 1;', ['BAD' => NAN]));
+?>
+===EOF===
+--EXPECTF--
+string(21) "Hello World,true,true"
+
+Warning: V8Js::createSnapshot(): Constant 'BAD' cannot be encoded as JSON in %s on line %d
+bool(false)
+===EOF===
@@ -0,0 +1,37 @@
+--TEST--
+Test V8Js::createSnapshot() : Multiple named contexts
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$snap = V8Js::createSnapshot([
+	'one' => 'var flavor = "one"; function double(x) { return 2 * x; }',
+	'two' => 'var flavor = "two";',
+]);
+var_dump(is_string($snap));
+
+$v8 = new V8Js('PHP', [], $snap, 'one');
+var_dump($v8->executeString('flavor + " " + double(21)'));
+var_dump($v8->executeString('typeof print'));
+
+$v8 = new V8Js('PHP', [], $snap, 'two');
+var_dump($v8->executeString('flavor + " " + typeof double'));
+
+$v8 = new V8Js('PHP', [], $snap);
+var_dump($v8->executeString('typeof flavor'));
+
+try {
+	new V8Js('PHP', [], $snap, 'three');
+} catch (V8JsException $e) {
+	var_dump($e->getMessage());
+}
+?>
+===EOF===
+--EXPECT--
+bool(true)
+string(6) "one 42"
+string(8) "function"
+string(13) "two undefined"
+string(9) "undefined"
+string(37) "Snapshot has no context named 'three'"
+===EOF===
@@ -0,0 +1,39 @@
+--TEST--
+Test V8Js::defineConstant() : Frozen read-only globals
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->defineConstant('CONFIG', ['locale' => 'de', 'features' => ['a', 'b'], 'limits' => ['max' => rand(5, 5)]]);
+
+var_dump($v8->executeString('
+	"use strict";
+	var errors = [];
+	try { CONFIG.locale = "en"; } catch (e) { errors.push("locale"); }
+	try { CONFIG.features.push("c"); } catch (e) { errors.push("push"); }
+	try { CONFIG.limits.max = 10; } catch (e) { errors.push("max"); }
+	try { CONFIG = null; } catch (e) { errors.push("assign"); }
+	errors.join() + " " + CONFIG.locale + " " + CONFIG.limits.max
+'));
+
+try {
+	$v8->defineConstant('CONFIG', []);
+} catch (V8JsException $e) {
+	var_dump($e->getMessage());
+}
+
+// Objects from JS are live, neither frozen nor walked (this one is cyclic)
+$live = $v8->executeString('var live = { count: 1 }; live.self = live; live');
+$v8->defineConstant('STATE', ['live' => $live, 'again' => $live]);
+var_dump($v8->executeString('
+	STATE.live.count ++;
+	[Object.isFrozen(STATE), Object.isFrozen(live), STATE.live === live, STATE.again.self === live, live.count].join()
+'));
+?>
+===EOF===
+--EXPECT--
+string(27) "locale,push,max,assign de 5"
+string(33) "Cannot redefine constant 'CONFIG'"
+string(22) "true,false,true,true,2"
+===EOF===
@@ -0,0 +1,42 @@
+--TEST--
+Test V8::executeString() : atob & btoa
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->executeString(<<<EOJS
+var_dump(btoa(""));
+var_dump(btoa("f"));
+var_dump(btoa("foobar"));
+var_dump(atob("Zm9vYmFy"));
+var_dump(atob(" Zm9v\nYg== "));
+var_dump(atob("Zm9vYg"));
+var_dump(atob(btoa("ÿ\u0000\u0080")).charCodeAt(0));
+
+try {
+	btoa("€");
+} catch (e) {
+	var_dump(e.message);
+}
+
+try {
+	atob("Zm9vY");
+} catch (e) {
+	var_dump(e.message);
+}
+EOJS
+);
+?>
+===EOF===
+--EXPECT--
+string(0) ""
+string(4) "Zg=="
+string(8) "Zm9vYmFy"
+string(6) "foobar"
+string(4) "foob"
+string(4) "foob"
+int(255)
+string(77) "InvalidCharacterError: string contains characters outside of the Latin1 range"
+string(68) "InvalidCharacterError: string to be decoded is not correctly encoded"
+===EOF===
@@ -0,0 +1,60 @@
+--TEST--
+Test V8::executeString() : TextEncoder & TextDecoder
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->executeString(<<<EOJS
+var enc = new TextEncoder();
+var bytes = enc.encode("héllo €");
+var_dump(enc.encoding);
+var_dump(bytes instanceof Uint8Array);
+var_dump(bytes.length);
+var_dump(Array.prototype.join.call(bytes, ","));
+
+var target = new Uint8Array(4);
+var res = enc.encodeInto("a€b", target);
+var_dump(res.read, res.written);
+
+var dec = new TextDecoder();
+var_dump(dec.decode(bytes));
+var_dump(dec.decode(bytes.buffer));
+var_dump(dec.decode(bytes.subarray(7)));
+var_dump(dec.decode(new Uint8Array([0xef, 0xbb, 0xbf, 0x41])));
+var_dump(new TextDecoder("utf-8", { ignoreBOM: true }).decode(new Uint8Array([0xef, 0xbb, 0xbf, 0x41])).length);
+var_dump(dec.decode(new Uint8Array([0x41, 0xff, 0x42])));
+var_dump(dec.decode());
+
+try {
+	new TextDecoder("utf-8", { fatal: true }).decode(new Uint8Array([0x41, 0xc3]));
+} catch (e) {
+	var_dump(e instanceof TypeError);
+}
+
+try {
+	new TextDecoder("latin1");
+} catch (e) {
+	var_dump(e instanceof RangeError);
+}
+EOJS
+);
+?>
+===EOF===
+--EXPECT--
+string(5) "utf-8"
+bool(true)
+int(10)
+string(38) "104,195,169,108,108,111,32,226,130,172"
+int(2)
+int(4)
+string(10) "héllo €"
+string(10) "héllo €"
+string(3) "€"
+string(1) "A"
+int(2)
+string(5) "A�B"
+string(0) ""
+bool(true)
+bool(true)
+===EOF===
@@ -0,0 +1,54 @@
+--TEST--
+Test V8::executeString() : Enum cases map to cached, read-only JS objects
+--SKIPIF--
+<?php
+require_once(dirname(__FILE__) . '/skipif.inc');
+
+if (PHP_VERSION_ID < 80100) {
+    die('SKIP enums require PHP 8.1');
+}
+?>
+--FILE--
+<?php
+enum Suit: string {
+	case Hearts = 'H';
+	case Spades = 'S';
+
+	public function label(string $prefix): string {
+		return $prefix . $this->name . '/' . $this->value;
+	}
+}
+
+enum Status {
+	case Active;
+}
+
+$v8 = new V8Js();
+$v8->a = Suit::Hearts;
+$v8->b = Suit::Hearts;
+$v8->c = Status::Active;
+$v8->check = function ($suit) { return $suit === Suit::Hearts; };
+
+var_dump($v8->executeString('
+	"use strict";
+	var frozen, sealed;
+	try { PHP.a.name = "x"; frozen = false; } catch (e) { frozen = e instanceof TypeError; }
+	try { delete PHP.a.name; sealed = false; } catch (e) { sealed = e instanceof TypeError; }
+	[PHP.a === PHP.b, PHP.a.name, PHP.a.value, PHP.c.name, "value" in PHP.c, frozen, sealed, PHP.a.name].join()
+'));
+var_dump($v8->executeString('PHP.check(PHP.a)'));
+var_dump($v8->executeString('PHP.a.label("suit:")'));
+var_dump($v8->executeString('PHP.a') === Suit::Hearts);
+
+ini_set('v8js.enum_as_value', 1);
+$v8->d = Suit::Spades;
+var_dump($v8->executeString('PHP.d'));
+?>
+===EOF===
+--EXPECT--
+string(43) "true,Hearts,H,Active,false,true,true,Hearts"
+bool(true)
+string(13) "suit:Hearts/H"
+bool(true)
+string(1) "S"
+===EOF===
@@ -0,0 +1,28 @@
+--TEST--
+Test V8Js::__construct() : Subclass members exported consistently across instances
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+class App extends V8Js {
+	public $name = 'app';
+	protected $hidden = 'no';
+	public static $static = 'no';
+
+	public function greet($who) { return "Hello $who"; }
+	protected function internal() {}
+	public function __get($name) { return null; }
+}
+
+for ($i = 0; $i < 2; $i ++) {
+	$app = new App();
+	var_dump($app->executeString('
+		[PHP.name, PHP.greet("JS"), typeof PHP.hidden, typeof PHP.internal, typeof PHP.__get, typeof PHP.executeString].join()
+	'));
+}
+?>
+===EOF===
+--EXPECT--
+string(52) "app,Hello JS,undefined,undefined,undefined,undefined"
+string(52) "app,Hello JS,undefined,undefined,undefined,undefined"
+===EOF===
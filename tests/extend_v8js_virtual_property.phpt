@@ -0,0 +1,29 @@
+--TEST--
+Test V8::executeString() : Virtual (hooked) properties of derived classes are skipped
+--SKIPIF--
+<?php
+require_once(dirname(__FILE__) . '/skipif.inc');
+
+if (PHP_VERSION_ID < 80400) {
+    die('SKIP property hooks require PHP 8.4');
+}
+?>
+--FILE--
+<?php
+class Foo extends V8Js {
+	public $before = 1;
+
+	public string $virtual {
+		get => 'hooked';
+	}
+
+	public $after = 2;
+}
+
+$v8 = new Foo();
+var_dump($v8->executeString('[PHP.before, "virtual" in PHP, PHP.after].join()'));
+?>
+===EOF===
+--EXPECT--
+string(9) "1,false,2"
+===EOF===
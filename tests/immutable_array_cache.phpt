@@ -0,0 +1,39 @@
+--TEST--
+Test V8::executeString() : Immutable arrays are converted once and frozen
+--SKIPIF--
+<?php
+require_once(dirname(__FILE__) . '/skipif.inc');
+
+if (!extension_loaded('Zend OPcache')) {
+    die('SKIP needs opcache for immutable arrays');
+}
+?>
+--INI--
+opcache.enable=1
+opcache.enable_cli=1
+v8js.immutable_array_cache=1
+--FILE--
+<?php
+function table() {
+	return ['a' => 1, 'list' => [1, 2]];
+}
+
+$v8 = new V8Js();
+$v8->t1 = table();
+$v8->t2 = table();
+$v8->mutable = [1, rand(2, 2)];
+
+var_dump($v8->executeString('
+	[PHP.t1 === PHP.t2, Object.isFrozen(PHP.t1), Object.isFrozen(PHP.t1.list), Object.isFrozen(PHP.mutable)].join()
+'));
+
+// opcache_reset() drops the cache, the next conversion creates a new object
+opcache_reset();
+$v8->t3 = table();
+var_dump($v8->executeString('[PHP.t1 === PHP.t3, Object.isFrozen(PHP.t3)].join()'));
+?>
+===EOF===
+--EXPECT--
+string(20) "true,true,true,false"
+string(10) "false,true"
+===EOF===
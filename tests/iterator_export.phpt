@@ -0,0 +1,68 @@
+--TEST--
+Test V8::executeString() : for...of over PHP Traversable objects
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+
+class Numbers implements IteratorAggregate {
+	public function getIterator(): Iterator {
+		yield 1;
+		yield 2;
+		yield 3;
+	}
+}
+
+class Countdown implements Iterator {
+	private $i;
+
+	public function __construct(private int $from) {}
+
+	public function rewind(): void { echo "rewind\n"; $this->i = $this->from; }
+	public function valid(): bool { return $this->i > 0; }
+	public function current(): mixed { return $this->i; }
+	public function key(): mixed { return $this->i; }
+	public function next(): void { $this->i --; }
+}
+
+$v8 = new V8Js();
+$v8->list = new ArrayIterator(['a' => 'x', 'b' => 'y']);
+$v8->numbers = new Numbers();
+$v8->countdown = new Countdown(3);
+
+var_dump($v8->executeString('[...PHP.list]'));
+var_dump($v8->executeString('Array.from(PHP.numbers).map(x => x * 2)'));
+
+$v8->executeString('
+	for (const i of PHP.countdown) {
+		var_dump(i);
+		if (i === 2) break;
+	}
+	const [first] = PHP.countdown;
+	var_dump(first);
+	var_dump(typeof PHP.list[Symbol.iterator]);
+');
+?>
+===EOF===
+--EXPECT--
+array(2) {
+  [0]=>
+  string(1) "x"
+  [1]=>
+  string(1) "y"
+}
+array(3) {
+  [0]=>
+  int(2)
+  [1]=>
+  int(4)
+  [2]=>
+  int(6)
+}
+rewind
+int(3)
+int(2)
+rewind
+int(3)
+string(8) "function"
+===EOF===
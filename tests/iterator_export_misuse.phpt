@@ -0,0 +1,28 @@
+--TEST--
+Test V8::executeString() : Iterator functions called on foreign receivers
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+
+class Plain {
+	public $a = 1;
+}
+
+$v8 = new V8Js();
+$v8->list = new ArrayIterator([1, 2]);
+$v8->plain = new Plain();
+
+var_dump($v8->executeString('
+	var it = PHP.list[Symbol.iterator](), errors = [];
+	try { it.next.call(new TextDecoder()); } catch (e) { errors.push(e instanceof TypeError); }
+	try { it.return.call({}); } catch (e) { errors.push(e instanceof TypeError); }
+	try { PHP.list[Symbol.iterator].call(PHP.plain); } catch (e) { errors.push(e instanceof TypeError); }
+	try { PHP.list[Symbol.iterator].call(PHP); } catch (e) { errors.push(e instanceof TypeError); }
+	errors.join() + " " + it.next().value
+'));
+?>
+===EOF===
+--EXPECT--
+string(21) "true,true,true,true 1"
+===EOF===
@@ -0,0 +1,39 @@
+--TEST--
+Test v8js_metrics() : process-wide counters
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--INI--
+v8js.metrics=1
+--FILE--
+<?php
+$before = v8js_metrics();
+
+$v8 = new V8Js();
+$v8->foo = function ($x) { return $x; };
+$v8->executeString('PHP.foo("abcd"); PHP.foo(1);');
+
+$script = $v8->compileString('1 + 1');
+$v8->executeScript($script);
+
+$after = v8js_metrics();
+
+foreach (['executions', 'compilations', 'isolate_creations', 'callbacks'] as $key) {
+	var_dump($key, $after[$key] - $before[$key]);
+}
+
+var_dump($after['conversion_bytes'] - $before['conversion_bytes'] >= 8);
+var_dump(array_sum($after['execution_us']) - array_sum($before['execution_us']));
+?>
+===EOF===
+--EXPECT--
+string(10) "executions"
+int(2)
+string(12) "compilations"
+int(2)
+string(17) "isolate_creations"
+int(1)
+string(9) "callbacks"
+int(2)
+bool(true)
+int(2)
+===EOF===
@@ -0,0 +1,28 @@
+--TEST--
+Test V8::executeString() : Re-exported PHP objects keep their JS wrapper
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+class Service {
+	public $tag;
+
+	public function self() { return $this; }
+}
+
+$service = new Service();
+
+$v8 = new V8Js();
+$v8->a = $service;
+$v8->b = $service;
+$v8->other = new Service();
+
+var_dump($v8->executeString('
+	PHP.a.tag = "x";
+	[PHP.a === PHP.b, PHP.a.self() === PHP.a, PHP.a.self().tag, PHP.a === PHP.other].join()
+'));
+?>
+===EOF===
+--EXPECT--
+string(17) "true,true,x,false"
+===EOF===
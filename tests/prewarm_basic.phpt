@@ -0,0 +1,41 @@
+--TEST--
+Test V8Js::prewarm() : Pre-warmed isolates are adopted by new instances
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--INI--
+v8js.metrics=1
+--FILE--
+<?php
+var_dump(V8Js::prewarm(0));
+var_dump(V8Js::prewarm(2));
+
+$before = v8js_metrics()['isolate_creations'];
+
+/* Failing constructor must not take an isolate from the pool */
+try {
+	new V8Js('PHP', [], null, 'ctx');
+} catch (V8JsException $e) {
+	echo $e->getMessage(), "\n";
+}
+
+$v8 = new V8Js();
+$v8->foo = 'bar';
+$v8->executeString('print(PHP.foo, "\n"); var x = 23;');
+
+var_dump(V8Js::prewarm());
+var_dump(v8js_metrics()['isolate_creations'] - $before);
+
+/* Pooled instances are independent contexts */
+$v8b = new V8Js();
+var_dump($v8b->executeString('typeof x'));
+?>
+===EOF===
+--EXPECT--
+int(0)
+int(2)
+snapshot_context requires a snapshot_blob
+bar
+int(1)
+int(0)
+string(9) "undefined"
+===EOF===
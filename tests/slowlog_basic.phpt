@@ -0,0 +1,42 @@
+--TEST--
+Test V8Js : slow log captures JS stack without terminating the script
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--INI--
+v8js.slowlog_threshold_ms=50
+--FILE--
+<?php
+$log = tempnam(sys_get_temp_dir(), 'v8js');
+ini_set('v8js.slowlog', $log);
+
+$JS = <<< EOT
+function spin(ms) {
+	var end = Date.now() + ms;
+	while (Date.now() < end) {}
+	return "done";
+}
+function outer() {
+	return spin(250);
+}
+outer();
+EOT;
+
+$v8 = new V8Js();
+var_dump($v8->executeString($JS, 'slow.js'));
+
+$lines = file($log, FILE_IGNORE_NEW_LINES);
+var_dump(count($lines) >= 3);
+var_dump((bool) preg_match("/^\[.*\] V8Js script 'slow.js' executing for \d+ ms$/", $lines[0]));
+/* column depends on where the loop got interrupted */
+var_dump(preg_replace('/:\d+\)$/', ':N)', $lines[1]), $lines[2]);
+
+unlink($log);
+?>
+===EOF===
+--EXPECT--
+string(4) "done"
+bool(true)
+bool(true)
+string(25) "    at spin (slow.js:3:N)"
+string(26) "    at outer (slow.js:7:9)"
+===EOF===
@@ -0,0 +1,27 @@
+--TEST--
+Test V8::executeString() : ASCII, Latin-1 and multi-byte strings round trip
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->strings = [str_repeat('ascii-', 10), "caf\u{e9} \u{fc}ber", "\u{20ac} \u{1f600}", ''];
+
+foreach ($v8->executeString('PHP.strings.map(function (s) { return [s, s.length]; })') as $pair) {
+	var_dump($pair[0], $pair[1]);
+}
+
+var_dump($v8->executeString('String.fromCharCode(0xe9, 0x41, 0xff)') === "\u{e9}A\u{ff}");
+?>
+===EOF===
+--EXPECT--
+string(60) "ascii-ascii-ascii-ascii-ascii-ascii-ascii-ascii-ascii-ascii-"
+int(60)
+string(11) "café über"
+int(9)
+string(8) "€ 😀"
+int(4)
+string(0) ""
+int(0)
+bool(true)
+===EOF===
@@ -0,0 +1,58 @@
+--TEST--
+Test V8Js::startTracing() : write Chrome trace-event file
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+class Foo {
+	function bar() {
+		return [1, 2, 3];
+	}
+}
+
+$file = tempnam(sys_get_temp_dir(), 'v8js');
+
+var_dump(V8Js::startTracing($file, 'v8js'));
+
+try {
+	V8Js::startTracing($file);
+} catch (V8JsException $e) {
+	var_dump($e->getMessage());
+}
+
+$v8 = new V8Js();
+$v8->foo = new Foo();
+$v8->executeString('PHP.foo.bar().length', 'trace.js');
+
+var_dump(V8Js::stopTracing());
+var_dump(V8Js::stopTracing());
+
+$trace = json_decode(file_get_contents($file), true);
+$names = [];
+foreach ($trace['traceEvents'] as $event) {
+	if ($event['cat'] === 'v8js') {
+		$names[$event['name']] = true;
+	}
+}
+ksort($names);
+var_dump(array_keys($names));
+
+unlink($file);
+?>
+===EOF===
+--EXPECT--
+bool(true)
+string(23) "Tracing already started"
+bool(true)
+bool(false)
+array(4) {
+  [0]=>
+  string(13) "V8Js::compile"
+  [1]=>
+  string(13) "V8Js::execute"
+  [2]=>
+  string(8) "callback"
+  [3]=>
+  string(12) "zval_to_v8js"
+}
+===EOF===
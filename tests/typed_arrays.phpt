@@ -0,0 +1,58 @@
+--TEST--
+Test V8Js::FLAG_TYPED_ARRAYS : Numeric lists to TypedArrays and back
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->ints = $v8->int32Array([1, -2, 3]);
+$v8->floats = $v8->float64Array([1, 2.5]);
+$v8->getList = function () { return [4, 5, 6.5]; };
+$v8->getMixed = function () { return [1, 'two']; };
+
+var_dump($v8->executeString('[PHP.ints instanceof Int32Array, PHP.floats instanceof Float64Array].join()'));
+var_dump($v8->executeString('
+	var l = PHP.getList(), m = PHP.getMixed();
+	[l instanceof Float64Array, Array.isArray(m)].join()
+', '', V8Js::FLAG_TYPED_ARRAYS));
+
+var_dump($v8->executeString('new Int16Array([1, -1, 300])', '', V8Js::FLAG_TYPED_ARRAYS));
+var_dump($v8->executeString('new Float32Array([0.5, 2])', '', V8Js::FLAG_TYPED_ARRAYS));
+// plain FORCE_ARRAY keeps converting element by element (narrowing to int)
+var_dump($v8->executeString('new Float32Array([0.5, 2])', '', V8Js::FLAG_FORCE_ARRAY));
+var_dump($v8->executeString('new Uint8Array(0)', '', V8Js::FLAG_TYPED_ARRAYS));
+
+try {
+	$v8->int32Array([1, 1.5]);
+} catch (V8JsException $e) {
+	var_dump($e->getMessage());
+}
+?>
+===EOF===
+--EXPECT--
+string(9) "true,true"
+string(9) "true,true"
+array(3) {
+  [0]=>
+  int(1)
+  [1]=>
+  int(-1)
+  [2]=>
+  int(300)
+}
+array(2) {
+  [0]=>
+  float(0.5)
+  [1]=>
+  float(2)
+}
+array(2) {
+  [0]=>
+  float(0.5)
+  [1]=>
+  int(2)
+}
+array(0) {
+}
+string(48) "Array must be a list of integers in 32-bit range"
+===EOF===
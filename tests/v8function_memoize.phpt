@@ -0,0 +1,51 @@
+--TEST--
+Test V8Function::memoize() : cached results for equal arguments
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$render = $v8->executeString(<<<EOJS
+var calls = 0;
+(function (props) {
+	calls ++;
+	return "<b>" + props.name + "</b>";
+})
+EOJS
+);
+
+var_dump($render->memoize() === $render);
+
+var_dump($render(['name' => 'foo']));
+var_dump($render(['name' => 'foo']));
+var_dump($render(['name' => 'bar']));
+var_dump($v8->executeString('calls'));
+
+// different key type, must not hit the cache
+var_dump($render([0 => 'x', 'name' => 'foo']));
+var_dump($v8->executeString('calls'));
+
+// objects are never cached
+var_dump($render(new ArrayObject()));
+var_dump($render(new ArrayObject()));
+var_dump($v8->executeString('calls'));
+
+$render->memoize(false);
+var_dump($render(['name' => 'foo']));
+var_dump($v8->executeString('calls'));
+?>
+===EOF===
+--EXPECT--
+bool(true)
+string(10) "<b>foo</b>"
+string(10) "<b>foo</b>"
+string(10) "<b>bar</b>"
+int(2)
+string(10) "<b>foo</b>"
+int(3)
+string(16) "<b>undefined</b>"
+string(16) "<b>undefined</b>"
+int(5)
+string(10) "<b>foo</b>"
+int(6)
+===EOF===
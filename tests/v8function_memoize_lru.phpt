@@ -0,0 +1,25 @@
+--TEST--
+Test V8Function::memoize() : cache is bounded and shared across wrappers
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--INI--
+v8js.memoize_cache_size=2
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->executeString('var calls = 0; function square(x) { calls ++; return x * x; }');
+$v8->executeString('square')->memoize();
+
+$square = $v8->executeString('square');
+$square(2);
+$square(3);
+$square(2);		// hit, 2 is most recently used now
+$square(4);		// evicts 3
+$square(2);		// hit
+$square(3);		// miss
+var_dump($v8->executeString('calls'));
+?>
+===EOF===
+--EXPECT--
+int(4)
+===EOF===
@@ -0,0 +1,31 @@
+--TEST--
+Test V8Function::memoize() : mark is shared by all wrappers of a function
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+$v8 = new V8Js();
+$v8->executeString('var calls = 0; function twice(x) { calls ++; return x * 2; }');
+
+$a = $v8->executeString('twice');
+$b = $v8->executeString('twice');
+
+// $a was created before memoize() was called on $b
+$b->memoize();
+var_dump($a(21), $b(21), $a(21));
+var_dump($v8->executeString('calls'));
+
+// $b was created before memoize(false) was called on $a
+$a->memoize(false);
+var_dump($b(21));
+var_dump($v8->executeString('calls'));
+?>
+===EOF===
+--EXPECT--
+int(42)
+int(42)
+int(42)
+int(1)
+int(42)
+int(2)
+===EOF===
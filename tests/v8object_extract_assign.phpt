@@ -0,0 +1,52 @@
+--TEST--
+Test V8Object::extract() and V8Object::assign() : bulk property access
+--SKIPIF--
+<?php require_once(dirname(__FILE__) . '/skipif.inc'); ?>
+--FILE--
+<?php
+
+$v8 = new V8Js();
+$obj = $v8->executeString('({ id: 7, author: { name: "Jane", tags: ["a", "b"] } })');
+
+var_dump($obj->extract(['id', 'author.name', 'author.tags.1', 'author.tags.length', 'missing.deep']));
+var_dump($obj->extract(['author'], V8Js::FLAG_FORCE_ARRAY));
+
+$v8->obj = $obj->assign(['id' => 8, 'title' => 'Hello', 3 => 'three']);
+$v8->executeString('var_dump(PHP.obj.id, PHP.obj.title, PHP.obj[3]);');
+
+$other = $v8->executeString('({ extract: function () { return "js"; } })');
+var_dump($other->extract([]));
+?>
+===EOF===
+--EXPECT--
+array(5) {
+  ["id"]=>
+  int(7)
+  ["author.name"]=>
+  string(4) "Jane"
+  ["author.tags.1"]=>
+  string(1) "b"
+  ["author.tags.length"]=>
+  int(2)
+  ["missing.deep"]=>
+  NULL
+}
+array(1) {
+  ["author"]=>
+  array(2) {
+    ["name"]=>
+    string(4) "Jane"
+    ["tags"]=>
+    array(2) {
+      [0]=>
+      string(1) "a"
+      [1]=>
+      string(1) "b"
+    }
+  }
+}
+int(8)
+string(5) "Hello"
+string(5) "three"
+string(2) "js"
+===EOF===
@@ -18,6 +18,7 @@
 #include "v8js_array_access.h"
 #include "v8js_exceptions.h"
 #include "v8js_object_export.h"
+#include "v8js_profiler.h"
 
 extern "C" {
 #include "php.h"
@@ -33,6 +34,7 @@ static zval v8js_array_access_dispatch(zend_object *object, const char *method_n
 {
 	zend_fcall_info fci;
 	zval php_value;
+	uint64_t profile_start = v8js_profile_start();
 
 	fci.size = sizeof(fci);
 	ZVAL_STRING(&fci.function_name, method_name);
@@ -50,6 +52,12 @@ static zval v8js_array_access_dispatch(zend_object *object, const char *method_n
 
 	zend_call_function(&fci, NULL);
 	zval_dtor(&fci.function_name);
+
+	if (profile_start) {
+		v8js_ctx *ctx = (v8js_ctx *) v8::Isolate::GetCurrent()->GetData(0);
+		v8js_profile_record(ctx, profile_start, object->ce, "::", method_name, strlen(method_name));
+	}
+
 	return php_value;
 }
 /* }}} */
@@ -0,0 +1,387 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_async.h"
+
+extern "C" {
+#include "zend_exceptions.h"
+#include "zend_interfaces.h"
+#if PHP_VERSION_ID >= 80100
+#include "zend_fibers.h"
+#endif
+}
+
+static void v8js_async_job_free(v8js_async_job *job) /* {{{ */
+{
+	for (int i = 0; i < job->argc; i ++) {
+		zval_ptr_dtor(&job->argv[i]);
+	}
+
+	if (job->argv) {
+		efree(job->argv);
+	}
+
+	/* Destroying a suspended fiber unwinds it (running finally blocks) */
+	bool in_async_fiber = V8JSG(in_async_fiber);
+	V8JSG(in_async_fiber) = true;
+	zval_ptr_dtor(&job->fiber);
+	V8JSG(in_async_fiber) = in_async_fiber;
+
+	zval_ptr_dtor(&job->callable);
+	job->resolver.Reset();
+	delete job;
+}
+/* }}} */
+
+/* JS side of an async PHP callback: queue the call, hand out a Promise */
+static void v8js_async_callback(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
+	v8js_ctx *ctx = (v8js_ctx *) isolate->GetData(0);
+	zval *callable = reinterpret_cast<zval *>(info.Data().As<v8::External>()->Value());
+	v8::Local<v8::Promise::Resolver> resolver;
+
+	if (!v8::Promise::Resolver::New(v8_context).ToLocal(&resolver)) {
+		return;
+	}
+
+	v8js_async_job *job = new v8js_async_job();
+	ZVAL_UNDEF(&job->fiber);
+	ZVAL_COPY(&job->callable, callable);
+	job->started = false;
+	job->argc = 0;
+	job->argv = info.Length() ? (zval *) safe_emalloc(info.Length(), sizeof(zval), 0) : NULL;
+	job->resolver.Reset(isolate, resolver);
+
+	for (int i = 0; i < info.Length(); i ++) {
+		v8::Local<v8::Object> param_object;
+
+		if (info[i]->IsObject() && info[i]->ToObject(v8_context).ToLocal(&param_object) && param_object->InternalFieldCount() == 2) {
+			/* This is a PHP object, passed to JS and back. */
+			ZVAL_OBJ_COPY(&job->argv[i], reinterpret_cast<zend_object *>(param_object->GetAlignedPointerFromInternalField(1)));
+		}
+		else if (v8js_to_zval(info[i], &job->argv[i], ctx->flags, isolate) == FAILURE) {
+			resolver->Reject(v8_context, v8::Exception::Error(V8JS_SYM("Converting parameter of async callback failed")));
+			info.GetReturnValue().Set(resolver->GetPromise());
+			v8js_async_job_free(job);
+			return;
+		}
+
+		job->argc ++;
+	}
+
+	ctx->async_jobs.push_back(job);
+	info.GetReturnValue().Set(resolver->GetPromise());
+}
+/* }}} */
+
+v8::MaybeLocal<v8::Function> v8js_async_function(v8js_ctx *c, zval *callable, v8::Isolate *isolate) /* {{{ */
+{
+	v8::Local<v8::Context> v8_context = v8::Local<v8::Context>::New(isolate, c->context);
+
+	/* Owned by the V8Js object, functions may outlive any PHP reference */
+	zval *data = (zval *) emalloc(sizeof(zval));
+	ZVAL_COPY(data, callable);
+	c->async_callables.push_back(data);
+
+	return v8::Function::New(v8_context, v8js_async_callback, v8::External::New(isolate, data));
+}
+/* }}} */
+
+#if PHP_VERSION_ID >= 80100
+static void v8js_fiber_call(zval *fiber, const char *method, size_t method_len, zval *retval, uint32_t argc, zval *argv) /* {{{ */
+{
+	zend_function *fn = reinterpret_cast<zend_function *>(zend_hash_str_find_ptr(&zend_ce_fiber->function_table, method, method_len));
+	zend_call_known_instance_method(fn, Z_OBJ_P(fiber), retval, argc, argv);
+}
+/* }}} */
+
+/* Start or resume the job's fiber; true once the fiber terminated, with its
+ * return value in retval (or EG(exception) set).  While the fiber runs calls
+ * into V8 are refused, see V8JS_CTX_PROLOGUE_EX. */
+static bool v8js_async_step(v8js_async_job *job, zval *retval) /* {{{ */
+{
+	zval tmp, terminated;
+
+	V8JSG(in_async_fiber) = true;
+
+	if (!job->started) {
+		job->started = true;
+		object_init_ex(&job->fiber, zend_ce_fiber);
+		zend_call_known_instance_method_with_1_params(zend_ce_fiber->constructor, Z_OBJ(job->fiber), NULL, &job->callable);
+
+		if (EG(exception)) {
+			V8JSG(in_async_fiber) = false;
+			return true;
+		}
+
+		v8js_fiber_call(&job->fiber, ZEND_STRL("start"), &tmp, job->argc, job->argv);
+	} else {
+		v8js_fiber_call(&job->fiber, ZEND_STRL("resume"), &tmp, 0, NULL);
+	}
+
+	V8JSG(in_async_fiber) = false;
+	zval_ptr_dtor(&tmp);
+
+	if (EG(exception)) {
+		return true;
+	}
+
+	v8js_fiber_call(&job->fiber, ZEND_STRL("isterminated"), &terminated, 0, NULL);
+
+	if (Z_TYPE(terminated) != IS_TRUE) {
+		return false;
+	}
+
+	v8js_fiber_call(&job->fiber, ZEND_STRL("getreturn"), retval, 0, NULL);
+	return true;
+}
+/* }}} */
+#endif
+
+#if PHP_VERSION_ID >= 80100
+/* Block until a suspended fiber may continue, after a round in which none of
+ * them terminated.  That's the V8Js::setAsyncWait() callable, given the number
+ * of pending jobs, or else a short sleep; false if the callable threw. */
+static bool v8js_async_wait(v8js_ctx *c, v8::Isolate *isolate) /* {{{ */
+{
+	if (Z_TYPE(c->async_wait) == IS_NULL) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return true;
+	}
+
+	zval retval, pending;
+	ZVAL_LONG(&pending, static_cast<zend_long>(c->async_jobs.size()));
+	ZVAL_UNDEF(&retval);
+
+	isolate->Exit();
+	{
+		v8::Unlocker unlocker(isolate);
+
+		zend_try {
+			call_user_function(EG(function_table), NULL, &c->async_wait, &retval, 1, &pending);
+		}
+		zend_catch {
+			V8JSG(fatal_error_abort) = 1;
+		}
+		zend_end_try();
+	}
+	isolate->Enter();
+
+	zval_ptr_dtor(&retval);
+	return !V8JSG(fatal_error_abort) && !EG(exception);
+}
+/* }}} */
+
+static void v8js_async_loop(v8js_ctx *c, v8::MaybeLocal<v8::Value> &result, v8::Isolate *isolate) /* {{{ */
+{
+	v8::Local<v8::Context> v8_context = v8::Local<v8::Context>::New(isolate, c->context);
+
+	while (!c->async_jobs.empty()) {
+		bool progress = false;
+
+		for (std::list<v8js_async_job *>::iterator it = c->async_jobs.begin(); it != c->async_jobs.end(); ) {
+			v8js_async_job *job = *it;
+			bool done = false;
+			zval retval;
+
+			ZVAL_UNDEF(&retval);
+
+			isolate->Exit();
+			{
+				v8::Unlocker unlocker(isolate);
+
+				zend_try {
+					done = v8js_async_step(job, &retval);
+				}
+				zend_catch {
+					V8JSG(in_async_fiber) = false;
+					V8JSG(fatal_error_abort) = 1;
+				}
+				zend_end_try();
+			}
+			isolate->Enter();
+
+			if (V8JSG(fatal_error_abort)) {
+				zval_ptr_dtor(&retval);
+				return;
+			}
+
+			if (!done) {
+				++ it;
+				continue;
+			}
+
+			it = c->async_jobs.erase(it);
+			progress = true;
+			v8::Local<v8::Promise::Resolver> resolver = v8::Local<v8::Promise::Resolver>::New(isolate, job->resolver);
+
+			if (EG(exception)) {
+				if (!(c->flags & V8JS_FLAG_PROPAGATE_PHP_EXCEPTIONS)) {
+					/* Leave the exception to executeString's caller */
+					v8js_async_job_free(job);
+					result = v8::MaybeLocal<v8::Value>();
+					return;
+				}
+
+				zval tmp_zv;
+				ZVAL_OBJ(&tmp_zv, EG(exception));
+				resolver->Reject(v8_context, zval_to_v8js(&tmp_zv, isolate));
+				zend_clear_exception();
+			} else {
+				resolver->Resolve(v8_context, zval_to_v8js(&retval, isolate));
+			}
+
+			zval_ptr_dtor(&retval);
+			v8js_async_job_free(job);
+
+			/* Run continuations now, they may queue further calls */
+			isolate->PerformMicrotaskCheckpoint();
+
+			if (c->time_limit_hit || c->memory_limit_hit || isolate->IsExecutionTerminating()) {
+				return;
+			}
+		}
+
+		if (c->time_limit_hit || c->memory_limit_hit) {
+			return;
+		}
+
+		/* Don't spin while all fibers wait for I/O */
+		if (!progress && !c->async_jobs.empty() && !v8js_async_wait(c, isolate)) {
+			if (EG(exception)) {
+				/* Leave the exception to executeString's caller */
+				result = v8::MaybeLocal<v8::Value>();
+			}
+			return;
+		}
+	}
+}
+/* }}} */
+#endif
+
+void v8js_async_cancel(v8js_ctx *c, v8::Isolate *isolate) /* {{{ */
+{
+	if (c->async_jobs.empty()) {
+		return;
+	}
+
+	v8::Local<v8::Context> v8_context = v8::Local<v8::Context>::New(isolate, c->context);
+	std::list<v8js_async_job *> jobs;
+	jobs.swap(c->async_jobs);
+
+	for (std::list<v8js_async_job *>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+		v8::Local<v8::Promise::Resolver> resolver = v8::Local<v8::Promise::Resolver>::New(isolate, (*it)->resolver);
+		resolver->Reject(v8_context, v8::Exception::Error(V8JS_SYM("Async callback cancelled")));
+		(*it)->resolver.Reset();
+	}
+
+	/* Unwinding the fibers runs PHP code, keep a pending exception aside */
+	zend_object *exception = EG(exception);
+	EG(exception) = NULL;
+
+	isolate->Exit();
+	{
+		v8::Unlocker unlocker(isolate);
+
+		zend_try {
+			for (std::list<v8js_async_job *>::iterator it = jobs.begin(); it != jobs.end(); ++it) {
+				v8js_async_job_free(*it);
+			}
+		}
+		zend_catch {
+			V8JSG(fatal_error_abort) = 1;
+		}
+		zend_end_try();
+	}
+	isolate->Enter();
+
+	if (EG(exception)) {
+		zend_clear_exception();
+	}
+
+	EG(exception) = exception;
+}
+/* }}} */
+
+void v8js_async_run(v8js_ctx *c, long flags, v8::MaybeLocal<v8::Value> &result, v8::Isolate *isolate) /* {{{ */
+{
+	isolate->PerformMicrotaskCheckpoint();
+
+#if PHP_VERSION_ID >= 80100
+	/* Not from PHP code running in one of our fibers */
+	if (!c->async_running) {
+		c->async_running = true;
+		v8js_async_loop(c, result, isolate);
+		c->async_running = false;
+
+		/* Left behind by limits or exceptions, don't resume them in a later call */
+		if (!V8JSG(fatal_error_abort)) {
+			v8js_async_cancel(c, isolate);
+		}
+	}
+#endif
+
+	if (V8JSG(fatal_error_abort) || EG(exception)) {
+		return;
+	}
+
+	v8::Local<v8::Value> value;
+
+	if ((flags & V8JS_FLAG_AWAIT) && result.ToLocal(&value) && value->IsPromise()) {
+		v8::Local<v8::Promise> promise = value.As<v8::Promise>();
+
+		if (promise->State() == v8::Promise::kFulfilled) {
+			result = promise->Result();
+		}
+		else if (promise->State() == v8::Promise::kRejected) {
+			promise->MarkAsHandled();
+			isolate->ThrowException(promise->Result());
+			result = v8::MaybeLocal<v8::Value>();
+		}
+	}
+}
+/* }}} */
+
+void v8js_async_free(v8js_ctx *c) /* {{{ */
+{
+	for (std::list<v8js_async_job *>::iterator it = c->async_jobs.begin(); it != c->async_jobs.end(); ++it) {
+		v8js_async_job_free(*it);
+	}
+	c->async_jobs.clear();
+
+	for (std::vector<zval *>::iterator it = c->async_callables.begin(); it != c->async_callables.end(); ++it) {
+		zval_ptr_dtor(*it);
+		efree(*it);
+	}
+	c->async_callables.clear();
+
+	zval_ptr_dtor(&c->async_wait);
+	ZVAL_NULL(&c->async_wait);
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,50 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_ASYNC_H
+#define V8JS_ASYNC_H
+
+/* Call of an async PHP callback, run in a Fiber by v8js_async_run() */
+struct v8js_async_job {
+	zval fiber;
+	zval callable;
+	zval *argv;
+	int argc;
+	bool started;
+	v8::Persistent<v8::Promise::Resolver> resolver;
+};
+
+/* Create JS function that calls the PHP callable in a Fiber, returning a Promise */
+v8::MaybeLocal<v8::Function> v8js_async_function(v8js_ctx *c, zval *callable, v8::Isolate *isolate);
+
+/* Run queued async callbacks until all of them settled, resuming suspended
+ * Fibers round-robin; with V8JS_FLAG_AWAIT a promise result is replaced by
+ * its value (or its reason is thrown). */
+void v8js_async_run(v8js_ctx *c, long flags, v8::MaybeLocal<v8::Value> &result, v8::Isolate *isolate);
+
+/* Reject pending calls and unwind their fibers, after execution was aborted */
+void v8js_async_cancel(v8js_ctx *c, v8::Isolate *isolate);
+
+/* Release async callables and (possibly suspended) jobs */
+void v8js_async_free(v8js_ctx *c);
+
+#endif /* V8JS_ASYNC_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
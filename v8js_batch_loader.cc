@@ -0,0 +1,233 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_batch_loader.h"
+
+extern "C" {
+#include "zend_exceptions.h"
+}
+
+static void v8js_batch_requests_free(std::vector<v8js_batch_request> &requests) /* {{{ */
+{
+	for (std::vector<v8js_batch_request>::iterator it = requests.begin(); it != requests.end(); ++it) {
+		zval_ptr_dtor(&it->key);
+		it->resolver.Reset();
+	}
+
+	requests.clear();
+}
+/* }}} */
+
+/* Look up the value of a key in the array returned by the batch function */
+static zval *v8js_batch_result_find(HashTable *result, zval *key) /* {{{ */
+{
+	if (Z_TYPE_P(key) == IS_LONG) {
+		return zend_hash_index_find(result, Z_LVAL_P(key));
+	}
+
+	return zend_hash_find(result, Z_STR_P(key));
+}
+/* }}} */
+
+/* Microtask, runs once all keys of the current tick have been requested */
+static void v8js_batch_dispatch(void *data) /* {{{ */
+{
+	v8js_batch_loader *loader = reinterpret_cast<v8js_batch_loader *>(data);
+	v8js_ctx *ctx = loader->ctx;
+	v8::Isolate *isolate = ctx->isolate;
+	v8::HandleScope handle_scope(isolate);
+	v8::Local<v8::Context> v8_context = v8::Local<v8::Context>::New(isolate, ctx->context);
+	v8::Context::Scope context_scope(v8_context);
+
+	/* Keys requested from now on make up the next batch */
+	std::vector<v8js_batch_request> requests;
+	requests.swap(loader->requests);
+	loader->scheduled = false;
+
+	zval keys, retval;
+	HashTable seen;
+
+	array_init_size(&keys, static_cast<uint32_t>(requests.size()));
+	zend_hash_init(&seen, static_cast<uint32_t>(requests.size()), NULL, NULL, 0);
+
+	/* Pass every key once, even if requested repeatedly */
+	for (std::vector<v8js_batch_request>::iterator it = requests.begin(); it != requests.end(); ++it) {
+		zval *added = Z_TYPE(it->key) == IS_LONG
+			? zend_hash_index_add_empty_element(&seen, Z_LVAL(it->key))
+			: zend_hash_add_empty_element(&seen, Z_STR(it->key));
+
+		if (added) {
+			Z_TRY_ADDREF(it->key);
+			add_next_index_zval(&keys, &it->key);
+		}
+	}
+
+	zend_hash_destroy(&seen);
+	ZVAL_UNDEF(&retval);
+
+	isolate->Exit();
+	{
+		v8::Unlocker unlocker(isolate);
+
+		zend_try {
+			call_user_function(EG(function_table), NULL, &loader->callable, &retval, 1, &keys);
+		}
+		zend_catch {
+			v8js_terminate_execution(isolate);
+			V8JSG(fatal_error_abort) = 1;
+		}
+		zend_end_try();
+	}
+	isolate->Enter();
+
+	zval_ptr_dtor(&keys);
+
+	if (V8JSG(fatal_error_abort)) {
+		zval_ptr_dtor(&retval);
+		v8js_batch_requests_free(requests);
+		return;
+	}
+
+	v8::Local<v8::Value> reason;
+
+	if (EG(exception)) {
+		if (!(ctx->flags & V8JS_FLAG_PROPAGATE_PHP_EXCEPTIONS)) {
+			v8js_terminate_execution(isolate);
+			zval_ptr_dtor(&retval);
+			v8js_batch_requests_free(requests);
+			return;
+		}
+
+		zval tmp_zv;
+		ZVAL_OBJ(&tmp_zv, EG(exception));
+		reason = zval_to_v8js(&tmp_zv, isolate);
+		zend_clear_exception();
+	}
+	else if (Z_TYPE(retval) != IS_ARRAY) {
+		reason = v8::Exception::TypeError(V8JS_SYM("Batch loader must return an array keyed by the requested keys"));
+	}
+
+	for (std::vector<v8js_batch_request>::iterator it = requests.begin(); it != requests.end(); ++it) {
+		v8::Local<v8::Promise::Resolver> resolver = v8::Local<v8::Value>::New(isolate, it->resolver).As<v8::Promise::Resolver>();
+
+		if (!reason.IsEmpty()) {
+			resolver->Reject(v8_context, reason);
+			continue;
+		}
+
+		zval *value = v8js_batch_result_find(Z_ARRVAL(retval), &it->key);
+		resolver->Resolve(v8_context, value ? zval_to_v8js(value, isolate) : V8JS_NULL);
+	}
+
+	zval_ptr_dtor(&retval);
+	v8js_batch_requests_free(requests);
+}
+/* }}} */
+
+/* JS side of a batch loader: load(key) returns a Promise of key's value */
+static void v8js_batch_load(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
+	v8js_batch_loader *loader = reinterpret_cast<v8js_batch_loader *>(info.Data().As<v8::External>()->Value());
+	v8::Local<v8::Promise::Resolver> resolver;
+	zval key;
+
+	if (!v8::Promise::Resolver::New(v8_context).ToLocal(&resolver)) {
+		return;
+	}
+
+	info.GetReturnValue().Set(resolver->GetPromise());
+
+	if (info.Length() < 1 || v8js_to_zval(info[0], &key, loader->ctx->flags, isolate) == FAILURE) {
+		resolver->Reject(v8_context, v8::Exception::TypeError(V8JS_SYM("Batch loader expects a key")));
+		return;
+	}
+
+	/* Keys end up as array keys on PHP side, hence just integers & strings,
+	 * normalised like PHP does for array keys */
+	zend_ulong index;
+
+	if (Z_TYPE(key) == IS_DOUBLE && zend_finite(Z_DVAL(key)) && Z_DVAL(key) == (double) zend_dval_to_lval(Z_DVAL(key))) {
+		ZVAL_LONG(&key, zend_dval_to_lval(Z_DVAL(key)));
+	}
+	else if (Z_TYPE(key) == IS_STRING && ZEND_HANDLE_NUMERIC_STR(Z_STRVAL(key), Z_STRLEN(key), index)) {
+		zval_ptr_dtor(&key);
+		ZVAL_LONG(&key, static_cast<zend_long>(index));
+	}
+
+	if (Z_TYPE(key) != IS_LONG && Z_TYPE(key) != IS_STRING) {
+		zval_ptr_dtor(&key);
+		resolver->Reject(v8_context, v8::Exception::TypeError(V8JS_SYM("Batch loader keys must be integers or strings")));
+		return;
+	}
+
+	loader->requests.emplace_back();
+	v8js_batch_request &request = loader->requests.back();
+	ZVAL_COPY_VALUE(&request.key, &key);
+	request.resolver.Reset(isolate, resolver);
+
+	if (!loader->scheduled) {
+		loader->scheduled = true;
+		isolate->EnqueueMicrotask(v8js_batch_dispatch, loader);
+	}
+}
+/* }}} */
+
+bool v8js_batch_loader_register(v8js_ctx *c, zend_string *name, zval *callable, v8::Isolate *isolate) /* {{{ */
+{
+	v8::Local<v8::Context> v8_context = v8::Local<v8::Context>::New(isolate, c->context);
+	v8::Local<v8::Function> fn;
+
+	v8js_batch_loader *loader = new v8js_batch_loader();
+	loader->ctx = c;
+	loader->scheduled = false;
+	ZVAL_COPY(&loader->callable, callable);
+	c->batch_loaders.push_back(loader);
+
+	if (!v8::Function::New(v8_context, v8js_batch_load, v8::External::New(isolate, loader)).ToLocal(&fn)) {
+		return false;
+	}
+
+	v8::Local<v8::String> fn_name = V8JS_ZSTR(name);
+	fn->SetName(fn_name);
+
+	return V8JS_GLOBAL(isolate)->Set(v8_context, fn_name, fn).FromMaybe(false);
+}
+/* }}} */
+
+void v8js_batch_loader_free(v8js_ctx *c) /* {{{ */
+{
+	for (std::vector<v8js_batch_loader *>::iterator it = c->batch_loaders.begin(); it != c->batch_loaders.end(); ++it) {
+		v8js_batch_requests_free((*it)->requests);
+		zval_ptr_dtor(&(*it)->callable);
+		delete *it;
+	}
+
+	c->batch_loaders.clear();
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,46 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_BATCH_LOADER_H
+#define V8JS_BATCH_LOADER_H
+
+/* Key requested from a batch loader, waiting for the batch to be dispatched */
+struct v8js_batch_request {
+	zval key;
+	v8js_persistent_value_t resolver;
+};
+
+/* DataLoader-style batching of PHP calls, see V8Js::registerBatchLoader() */
+struct v8js_batch_loader {
+	v8js_ctx *ctx;
+	zval callable;
+	std::vector<v8js_batch_request> requests;
+	bool scheduled;
+};
+
+/* Register loader function under passed name on the global object */
+bool v8js_batch_loader_register(v8js_ctx *c, zend_string *name, zval *callable, v8::Isolate *isolate);
+
+/* Release all batch loaders (and keys still waiting) */
+void v8js_batch_loader_free(v8js_ctx *c);
+
+#endif /* V8JS_BATCH_LOADER_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
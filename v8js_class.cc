@@ -21,19 +21,32 @@
 
 #include "php_v8js_macros.h"
 #include "v8js_v8.h"
+#include "v8js_async.h"
+#include "v8js_batch_loader.h"
+#include "v8js_console.h"
+#include "v8js_dtrace.h"
+#include "v8js_memoize.h"
+#include "v8js_metrics.h"
+#include "v8js_prewarm.h"
+#include "v8js_profiler.h"
+#include "v8js_tracing.h"
 #include "v8js_exceptions.h"
+#include "v8js_iterator_export.h"
 #include "v8js_v8object_class.h"
 #include "v8js_object_export.h"
 #include "v8js_timer.h"
 
 extern "C" {
 #include "php.h"
+#include "php_ini.h"
 #include "ext/date/php_date.h"
+#include "ext/json/php_json.h"
 #include "ext/standard/php_string.h"
 #include "zend_interfaces.h"
 #include "zend_closures.h"
 #include "ext/spl/spl_exceptions.h"
 #include "zend_exceptions.h"
+#include "zend_smart_str.h"
 }
 
 #define PHP_V8JS_SCRIPT_RES_NAME "V8Js script"
@@ -98,6 +111,21 @@ static void v8js_free_storage(zend_object *object) /* {{{ */
 	c->global_template.~Persistent();
 	c->array_tmpl.Reset();
 	c->array_tmpl.~Persistent();
+	c->iterator_tmpl.Reset();
+	c->iterator_tmpl.~Persistent();
+
+	/* Enum case wrappers are also in weak_objects (which holds the reference), just drop the handles */
+	for (std::unordered_map<zend_object *, v8js_persistent_obj_t>::iterator it = c->enum_cases.begin();
+		 it != c->enum_cases.end(); ++it) {
+		it->second.Reset();
+	}
+	c->enum_cases.~unordered_map();
+
+	for (std::unordered_map<HashTable *, v8js_persistent_value_t>::iterator it = c->immutable_arrays.begin();
+		 it != c->immutable_arrays.end(); ++it) {
+		it->second.Reset();
+	}
+	c->immutable_arrays.~unordered_map();
 
 	/* Clear persistent call_impl & method_tmpls templates */
 	for (std::map<v8js_function_tmpl_t *, v8js_function_tmpl_t>::iterator it = c->call_impls.begin();
@@ -127,12 +155,30 @@ static void v8js_free_storage(zend_object *object) /* {{{ */
 	}
 	c->accessor_list.~vector();
 
+	for (std::map<std::string, v8js_global_binding *>::iterator it = c->global_bindings.begin();
+		 it != c->global_bindings.end(); ++it) {
+		v8js_global_binding_dtor(it->second);
+	}
+	c->global_bindings.~map();
+
 	/* Clear global object, dispose context */
 	if (!c->context.IsEmpty()) {
 		c->context.Reset();
 	}
 	c->context.~Persistent();
 
+	/* Release PHP iterators (and thus their objects) still held by JS */
+	v8js_iterator_export_free(c);
+	c->php_iterators.~list();
+
+	/* Unwind suspended fibers of async callbacks */
+	v8js_async_free(c);
+	c->async_jobs.~list();
+	c->async_callables.~vector();
+
+	v8js_batch_loader_free(c);
+	c->batch_loaders.~vector();
+
 	/* Dispose yet undisposed weak refs */
 	for (std::map<zend_object *, v8js_persistent_obj_t>::iterator it = c->weak_objects.begin();
 		 it != c->weak_objects.end(); ++it) {
@@ -168,6 +214,14 @@ static void v8js_free_storage(zend_object *object) /* {{{ */
 	}
 	c->script_objects.~vector();
 
+	c->console_buffer.~deque();
+
+	v8js_memoize_clear(c);
+	c->memo_cache.~unordered_map();
+	c->memo_lru.~list();
+
+	c->callback_profile.~unordered_map();
+
 	/* Clear persistent handles in module cache */
 	for (std::map<char *, v8js_persistent_value_t>::iterator it = c->modules_loaded.begin();
 		 it != c->modules_loaded.end(); ++it) {
@@ -210,20 +264,32 @@ static zend_object* v8js_new(zend_class_entry *ce) /* {{{ */
 	new(&c->context) v8::Persistent<v8::Context>();
 	new(&c->global_template) v8::Persistent<v8::FunctionTemplate>();
 	new(&c->array_tmpl) v8::Persistent<v8::FunctionTemplate>();
+	new(&c->iterator_tmpl) v8::Persistent<v8::FunctionTemplate>();
 
 	new(&c->modules_stack) std::vector<char*>();
 	new(&c->modules_loaded) std::map<char *, v8js_persistent_value_t, cmp_str>;
 
 	new(&c->template_cache) std::map<const zend_string *,v8js_function_tmpl_t>();
 	new(&c->accessor_list) std::vector<v8js_accessor_ctx *>();
+	new(&c->global_bindings) std::map<std::string, v8js_global_binding *>();
 
 	new(&c->weak_closures) std::map<v8js_function_tmpl_t *, v8js_persistent_obj_t>();
 	new(&c->weak_objects) std::map<zend_object *, v8js_persistent_obj_t>();
+	new(&c->enum_cases) std::unordered_map<zend_object *, v8js_persistent_obj_t>();
+	new(&c->immutable_arrays) std::unordered_map<HashTable *, v8js_persistent_value_t>();
 	new(&c->call_impls) std::map<v8js_function_tmpl_t *, v8js_function_tmpl_t>();
 	new(&c->method_tmpls) std::map<std::pair<zend_class_entry *, zend_function *>, v8js_function_tmpl_t>();
 
 	new(&c->v8js_v8objects) std::list<v8js_v8object *>();
+	new(&c->php_iterators) std::list<v8js_php_iterator *>();
+	new(&c->async_jobs) std::list<v8js_async_job *>();
+	new(&c->async_callables) std::vector<zval *>();
+	new(&c->batch_loaders) std::vector<v8js_batch_loader *>();
 	new(&c->script_objects) std::vector<v8js_script *>();
+	new(&c->console_buffer) std::deque<v8js_console_entry>();
+	new(&c->memo_cache) std::unordered_map<std::string, v8js_memo_entry>();
+	new(&c->memo_lru) std::list<const std::string *>();
+	new(&c->callback_profile) std::unordered_map<std::string, v8js_callback_stats>();
 
 	// @fixme following is const, run on startup
 	v8js_object_handlers.offset = XtOffsetOf(struct v8js_ctx, std);
@@ -249,13 +315,172 @@ static void v8js_fatal_error_handler(const char *location, const char *message)
 	((ZSTR_LEN(key) == sizeof(mname) - 1) &&		\
 	 !strncasecmp(ZSTR_VAL(key), mname, ZSTR_LEN(key)))
 
-/* {{{ proto void V8Js::__construct([string object_name [, array variables [, string snapshot_blob]]])
+/* Multi-context snapshots (see V8Js::createSnapshot) are prefixed with a table
+ * mapping context names to indexes for v8::Context::FromSnapshot:
+ *   magic, uint32 count, count * (uint32 index, uint32 name length, name),
+ *   zero padding to 8 bytes, followed by V8's startup blob */
+#define V8JS_SNAPSHOT_MAGIC "V8JSCTX1"
+#define V8JS_SNAPSHOT_MAGIC_LEN (sizeof(V8JS_SNAPSHOT_MAGIC) - 1)
+
+/* Returns length of the table (0 for plain snapshots, -1 if malformed)
+ * and sets index to the context named name (-1 if not found) */
+static zend_long v8js_snapshot_parse_header(const char *data, size_t len, const zend_string *name, int *index) /* {{{ */
+{
+	uint32_t count, context_index, name_len;
+	size_t offset = V8JS_SNAPSHOT_MAGIC_LEN;
+
+	*index = -1;
+
+	if (len < V8JS_SNAPSHOT_MAGIC_LEN + sizeof(count) || memcmp(data, V8JS_SNAPSHOT_MAGIC, V8JS_SNAPSHOT_MAGIC_LEN) != 0) {
+		return 0;
+	}
+
+	memcpy(&count, data + offset, sizeof(count));
+	offset += sizeof(count);
+
+	for (uint32_t i = 0; i < count; i ++) {
+		if (len - offset < sizeof(context_index) + sizeof(name_len)) {
+			return -1;
+		}
+
+		memcpy(&context_index, data + offset, sizeof(context_index));
+		memcpy(&name_len, data + offset + sizeof(context_index), sizeof(name_len));
+		offset += sizeof(context_index) + sizeof(name_len);
+
+		if (len - offset < name_len) {
+			return -1;
+		}
+
+		if (name && ZSTR_LEN(name) == name_len && memcmp(ZSTR_VAL(name), data + offset, name_len) == 0) {
+			*index = static_cast<int>(context_index);
+		}
+
+		offset += name_len;
+	}
+
+	offset = ZEND_MM_ALIGNED_SIZE_EX(offset, 8);
+	return offset <= len ? static_cast<zend_long>(offset) : -1;
+}
+/* }}} */
+
+/* Contexts deserialized from a snapshot don't take a global template,
+ * hence copy the builtins from an instance of it */
+static void v8js_install_global_template(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::ObjectTemplate> global_template) /* {{{ */
+{
+	v8::Local<v8::Object> builtins, global = context->Global();
+	v8::Local<v8::Array> names;
+
+	if (!global_template->NewInstance(context).ToLocal(&builtins) ||
+		!builtins->GetOwnPropertyNames(context, v8::ALL_PROPERTIES).ToLocal(&names)) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < names->Length(); i ++) {
+		v8::Local<v8::Value> name, value;
+
+		if (!names->Get(context, i).ToLocal(&name) || !builtins->Get(context, name).ToLocal(&value)) {
+			continue;
+		}
+
+		v8::PropertyAttribute attributes = builtins->GetPropertyAttributes(context, name).FromMaybe(v8::None);
+		global->DefineOwnProperty(context, name.As<v8::Name>(), value, attributes);
+	}
+}
+/* }}} */
+
+static bool v8js_property_offset_less(const zend_property_info *a, const zend_property_info *b) /* {{{ */
+{
+	return a->offset < b->offset;
+}
+/* }}} */
+
+/* Look up (or compute) which properties and methods __construct exports
+ * to the PHP object of instances of the passed class */
+static const v8js_export_plan &v8js_get_export_plan(zend_class_entry *ce) /* {{{ */
+{
+	std::unordered_map<zend_class_entry *, v8js_export_plan>::iterator it = V8JSG(export_plans).find(ce);
+
+	if (it != V8JSG(export_plans).end()) {
+		return it->second;
+	}
+
+	v8js_export_plan &plan = V8JSG(export_plans)[ce];
+	zend_property_info *property_info;
+	zend_string *key;
+	void *ptr;
+
+	ZEND_HASH_FOREACH_PTR(&ce->properties_info, property_info) {
+		if ((property_info->flags & ZEND_ACC_PUBLIC) && !(property_info->flags & ZEND_ACC_STATIC)) {
+#ifdef ZEND_ACC_VIRTUAL
+			/* Hooked properties without backing store have no slot (offset) */
+			if (property_info->flags & ZEND_ACC_VIRTUAL) {
+				continue;
+			}
+#endif
+			plan.properties.push_back(property_info);
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	/* Keep declaration order, like iterating the properties table did */
+	std::sort(plan.properties.begin(), plan.properties.end(), v8js_property_offset_less);
+
+	ZEND_HASH_FOREACH_STR_KEY_PTR(&ce->function_table, key, ptr) {
+		zend_function *method_ptr = reinterpret_cast<zend_function *>(ptr);
+
+		if ((method_ptr->common.fn_flags & ZEND_ACC_PUBLIC) == 0) {
+			/* Allow only public methods */
+			continue;
+		}
+
+		if ((method_ptr->common.fn_flags & (ZEND_ACC_CTOR|ZEND_ACC_DTOR)) != 0) {
+			/* no __construct, __destruct(), or __clone() functions */
+			continue;
+		}
+
+		/* hide (do not export) other PHP magic functions */
+		if (IS_MAGIC_FUNC(ZEND_CALLSTATIC_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_SLEEP_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_WAKEUP_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_SET_STATE_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_GET_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_SET_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_UNSET_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_CALL_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_INVOKE_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_TOSTRING_FUNC_NAME) ||
+			IS_MAGIC_FUNC(ZEND_ISSET_FUNC_NAME)) {
+			continue;
+		}
+
+		const zend_function_entry *fe;
+		for (fe = v8js_methods; fe->fname; fe ++) {
+			if (strcmp(fe->fname, ZSTR_VAL(method_ptr->common.function_name)) == 0) {
+				break;
+			}
+		}
+
+		if(fe->fname) {
+			/* Method belongs to \V8Js class itself, never export to V8, even if
+			 * it is overriden in a derived class. */
+			continue;
+		}
+
+		plan.methods.push_back(method_ptr);
+	} ZEND_HASH_FOREACH_END();
+
+	return plan;
+}
+/* }}} */
+
+/* {{{ proto void V8Js::__construct([string object_name [, array variables [, string snapshot_blob [, string snapshot_context]]]])
    __construct for V8Js */
 static PHP_METHOD(V8Js, __construct)
 {
 	zend_string *object_name = NULL;
 	zval *vars_arr = NULL;
 	zval *snapshot_blob = NULL;
+	zend_string *snapshot_context = NULL;
+	int snapshot_context_index = -1;
 
 	v8js_ctx *c = Z_V8JS_CTX_OBJ_P(getThis())
 
@@ -264,7 +489,7 @@ static PHP_METHOD(V8Js, __construct)
 		return;
 	}
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS(), "|S!az", &object_name, &vars_arr, &snapshot_blob) == FAILURE) {
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "|S!azS!", &object_name, &vars_arr, &snapshot_blob, &snapshot_context) == FAILURE) {
 		return;
 	}
 
@@ -276,13 +501,6 @@ static PHP_METHOD(V8Js, __construct)
 
 	new (&c->create_params) v8::Isolate::CreateParams();
 
-#ifdef USE_INTERNAL_ALLOCATOR
-	static ArrayBufferAllocator array_buffer_allocator;
-	c->create_params.array_buffer_allocator = &array_buffer_allocator;
-#else
-	c->create_params.array_buffer_allocator = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
-#endif
-
 	new (&c->snapshot_blob) v8::StartupData();
 	if (snapshot_blob) {
 		if (Z_TYPE_P(snapshot_blob) == IS_STRING) {
@@ -294,16 +512,58 @@ static PHP_METHOD(V8Js, __construct)
 				return;
 			}
 
-			c->snapshot_blob.data = Z_STRVAL_P(snapshot_blob);
-			c->snapshot_blob.raw_size = static_cast<int>(Z_STRLEN_P(snapshot_blob));
+			zend_long header_len = v8js_snapshot_parse_header(Z_STRVAL_P(snapshot_blob), Z_STRLEN_P(snapshot_blob),
+				snapshot_context, &snapshot_context_index);
+
+			if (header_len < 0) {
+				zend_throw_exception(php_ce_v8js_exception, "Malformed snapshot context table", 0);
+				return;
+			}
+
+			if (snapshot_context && snapshot_context_index < 0) {
+				zend_throw_exception_ex(php_ce_v8js_exception, 0, "Snapshot has no context named '%s'", ZSTR_VAL(snapshot_context));
+				return;
+			}
+
+			c->snapshot_blob.data = Z_STRVAL_P(snapshot_blob) + header_len;
+			c->snapshot_blob.raw_size = static_cast<int>(Z_STRLEN_P(snapshot_blob) - header_len);
 			c->create_params.snapshot_blob = &c->snapshot_blob;
 		} else {
 			php_error_docref(NULL, E_WARNING, "Argument snapshot_blob expected to be of string type");
 		}
 	}
 
-	c->isolate = v8::Isolate::New(c->create_params);
+	if (snapshot_context && !c->create_params.snapshot_blob) {
+		zend_throw_exception(php_ce_v8js_exception, "snapshot_context requires a snapshot_blob", 0);
+		return;
+	}
+
+	/* Adopt a pre-warmed isolate, unless a snapshot was explicitly asked for.
+	 * Only now that all arguments were validated, there's no way back to the pool. */
+	v8js_prewarmed *prewarmed = snapshot_blob ? NULL : v8js_prewarm_acquire();
+
+#ifdef USE_INTERNAL_ALLOCATOR
+	static ArrayBufferAllocator array_buffer_allocator;
+	c->create_params.array_buffer_allocator = &array_buffer_allocator;
+#else
+	c->create_params.array_buffer_allocator = prewarmed
+		? prewarmed->allocator
+		: v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+#endif
+
+	if (prewarmed) {
+		c->isolate = prewarmed->isolate;
+	} else {
+		c->isolate = v8::Isolate::New(c->create_params);
+		V8JS_METRIC_INC(isolate_creations);
+	}
+
 	c->isolate->SetData(0, c);
+	v8js_metrics_register_gc(c->isolate);
+
+#ifdef HAVE_V8JS_DTRACE
+	v8js_dtrace_register_gc(c->isolate);
+#endif
 
 	c->time_limit = 0;
 	c->time_limit_hit = false;
@@ -312,6 +572,7 @@ static PHP_METHOD(V8Js, __construct)
 
 	ZVAL_NULL(&c->module_normaliser);
 	ZVAL_NULL(&c->module_loader);
+	ZVAL_NULL(&c->async_wait);
 
 	// Isolate execution
 	v8::Isolate *isolate = c->isolate;
@@ -333,8 +594,22 @@ static PHP_METHOD(V8Js, __construct)
 	/* Register builtin methods */
 	v8js_register_methods(global_template, c);
 
-	/* Create context */
-	v8::Local<v8::Context> context = v8::Context::New(isolate, nullptr, global_template);
+	/* Create context, either the default one or a named one from the snapshot */
+	v8::Local<v8::Context> context;
+
+	if (prewarmed) {
+		context = v8::Local<v8::Context>::New(isolate, prewarmed->context);
+		v8js_install_global_template(isolate, context, global_template);
+
+		prewarmed->context.Reset();
+		delete prewarmed;
+	} else if (snapshot_context_index >= 0) {
+		if (v8::Context::FromSnapshot(isolate, static_cast<size_t>(snapshot_context_index)).ToLocal(&context)) {
+			v8js_install_global_template(isolate, context, global_template);
+		}
+	} else {
+		context = v8::Context::New(isolate, nullptr, global_template);
+	}
 
 	if (context.IsEmpty()) {
 		zend_throw_exception(php_ce_v8js_exception, "Failed to create V8 context.", 0);
@@ -391,76 +666,36 @@ static PHP_METHOD(V8Js, __construct)
 	V8JS_GLOBAL(isolate)->DefineOwnProperty(context, object_name_js, php_obj, v8::ReadOnly);
 
 	/* Export public property values */
-	HashTable *properties = zend_std_get_properties(Z_OBJ_P(getThis()));
-	zval *value;
-	zend_string *member;
-
-	ZEND_HASH_FOREACH_STR_KEY(properties, member) {
-		zend_property_info *property_info = zend_get_property_info(c->std.ce, member, 1);
-		if(property_info &&
-		   property_info != ZEND_WRONG_PROPERTY_INFO &&
-		   (property_info->flags & ZEND_ACC_PUBLIC)) {
-			if (ZSTR_LEN(member) > std::numeric_limits<int>::max()) {
-				zend_throw_exception(php_ce_v8js_exception,
-					"Property name exceeds maximum supported length", 0);
-				return;
-			}
+	const v8js_export_plan &plan = v8js_get_export_plan(c->std.ce);
 
-			v8::Local<v8::Name> key = V8JS_ZSYM(member);
+	for (std::vector<zend_property_info *>::const_iterator it = plan.properties.begin();
+		 it != plan.properties.end(); ++it) {
+		zend_string *member = (*it)->name;
 
-			/* Write value to PHP JS object */
-			value = OBJ_PROP(Z_OBJ_P(getThis()), property_info->offset);
-			php_obj->DefineOwnProperty(context, key, zval_to_v8js(value, isolate), v8::ReadOnly);
+		if (ZSTR_LEN(member) > std::numeric_limits<int>::max()) {
+			zend_throw_exception(php_ce_v8js_exception,
+				"Property name exceeds maximum supported length", 0);
+			return;
 		}
-	} ZEND_HASH_FOREACH_END();
-
-	/* Add pointer to zend object */
-	php_obj->SetAlignedPointerInInternalField(1, Z_OBJ_P(getThis()));
-
-	/* Export public methods */
-	void *ptr;
-	zend_string *key;
-
-	ZEND_HASH_FOREACH_STR_KEY_PTR(&c->std.ce->function_table, key, ptr) {
-		zend_function *method_ptr = reinterpret_cast<zend_function *>(ptr);
 
-		if ((method_ptr->common.fn_flags & ZEND_ACC_PUBLIC) == 0) {
-			/* Allow only public methods */
-			continue;
-		}
+		zval *value = OBJ_PROP(Z_OBJ_P(getThis()), (*it)->offset);
 
-		if ((method_ptr->common.fn_flags & (ZEND_ACC_CTOR|ZEND_ACC_DTOR)) != 0) {
-			/* no __construct, __destruct(), or __clone() functions */
+		if (Z_TYPE_P(value) == IS_UNDEF) {
+			/* unset() or uninitialized typed property */
 			continue;
 		}
 
-		/* hide (do not export) other PHP magic functions */
-		if (IS_MAGIC_FUNC(ZEND_CALLSTATIC_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_SLEEP_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_WAKEUP_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_SET_STATE_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_GET_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_SET_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_UNSET_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_CALL_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_INVOKE_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_TOSTRING_FUNC_NAME) ||
-			IS_MAGIC_FUNC(ZEND_ISSET_FUNC_NAME)) {
-			continue;
-		}
+		/* Write value to PHP JS object */
+		php_obj->DefineOwnProperty(context, V8JS_ZSYM(member), zval_to_v8js(value, isolate), v8::ReadOnly);
+	}
 
-		const zend_function_entry *fe;
-		for (fe = v8js_methods; fe->fname; fe ++) {
-			if (strcmp(fe->fname, ZSTR_VAL(method_ptr->common.function_name)) == 0) {
-				break;
-			}
-		}
+	/* Add pointer to zend object */
+	php_obj->SetAlignedPointerInInternalField(1, Z_OBJ_P(getThis()));
 
-		if(fe->fname) {
-			/* Method belongs to \V8Js class itself, never export to V8, even if
-			 * it is overriden in a derived class. */
-			continue;
-		}
+	/* Export public methods */
+	for (std::vector<zend_function *>::const_iterator it = plan.methods.begin();
+		 it != plan.methods.end(); ++it) {
+		zend_function *method_ptr = *it;
 
 		if (ZSTR_LEN(method_ptr->common.function_name) > std::numeric_limits<int>::max()) {
 			zend_throw_exception(php_ce_v8js_exception,
@@ -478,7 +713,7 @@ static PHP_METHOD(V8Js, __construct)
 		persistent_ft->Reset(isolate, ft);
 
 		php_obj->CreateDataProperty(context, method_name, ft->GetFunction(context).ToLocalChecked());
-	} ZEND_HASH_FOREACH_END();
+	}
 }
 /* }}} */
 
@@ -502,7 +737,7 @@ PHP_METHOD(V8Js, __wakeup)
 }
 /* }}} */
 
-static void v8js_compile_script(zval *this_ptr, const zend_string *str, const zend_string *identifier, v8js_script **ret)
+static void v8js_compile_script(zval *this_ptr, const zend_string *str, const zend_string *identifier, const zend_string *code_cache, v8js_script **ret)
 {
 	v8js_script *res = NULL;
 
@@ -529,8 +764,44 @@ static void v8js_compile_script(zval *this_ptr, const zend_string *str, const ze
 		return;
 	}
 
-	v8::Local<v8::String> source = V8JS_ZSTR(str);
-	v8::MaybeLocal<v8::Script> script = v8::Script::Compile(v8::Local<v8::Context>::New(isolate, c->context), source, &origin);
+	if (code_cache && ZSTR_LEN(code_cache) > std::numeric_limits<int>::max()) {
+		zend_throw_exception(php_ce_v8js_exception,
+			"Code cache exceeds maximum supported length", 0);
+		return;
+	}
+
+	/* After argument checks, so every compile__entry has its compile__return */
+	const char *probe_identifier = identifier ? ZSTR_VAL(identifier) : "V8Js::compileString()";
+	V8JS_PROBE2(compile__entry, probe_identifier, ZSTR_LEN(str));
+	uint64_t probe_start = V8JS_PROBE_TIMESTAMP(compile__return);
+
+	v8::MaybeLocal<v8::Script> script;
+	{
+		v8js_trace_scope trace_scope("V8Js::compile", "identifier", probe_identifier);
+
+		if (code_cache) {
+			/* Source takes ownership of CachedData, the buffer stays ours */
+			v8::ScriptCompiler::Source source(V8JS_ZSTR(str), origin,
+				new v8::ScriptCompiler::CachedData(reinterpret_cast<const uint8_t *>(ZSTR_VAL(code_cache)),
+					static_cast<int>(ZSTR_LEN(code_cache)), v8::ScriptCompiler::CachedData::BufferNotOwned));
+
+			script = v8::ScriptCompiler::Compile(v8::Local<v8::Context>::New(isolate, c->context), &source,
+				v8::ScriptCompiler::kConsumeCodeCache);
+
+			if (!script.IsEmpty()) {
+				if (source.GetCachedData()->rejected) {
+					V8JS_METRIC_INC(code_cache_rejects);
+				} else {
+					V8JS_METRIC_INC(code_cache_hits);
+				}
+			}
+		} else {
+			script = v8::Script::Compile(v8::Local<v8::Context>::New(isolate, c->context), V8JS_ZSTR(str), &origin);
+		}
+	}
+
+	V8JS_PROBE3(compile__return, probe_identifier, v8js_probe_now() - probe_start, !script.IsEmpty());
+	V8JS_METRIC_INC(compilations);
 
 	/* Compile errors? */
 	if (script.IsEmpty()) {
@@ -572,7 +843,7 @@ static void v8js_execute_script(zval *this_ptr, v8js_script *res, long flags, lo
 			return script->Run(v8::Local<v8::Context>::New(isolate, c->context));
 		};
 
-		v8js_v8_call(c, return_value, flags, time_limit, memory_limit, v8_call);
+		v8js_v8_call(c, return_value, flags, time_limit, memory_limit, res->name, v8_call);
 	}
 
 	if(V8JSG(fatal_error_abort)) {
@@ -600,7 +871,7 @@ static PHP_METHOD(V8Js, executeString)
 		return;
 	}
 
-	v8js_compile_script(getThis(), str, identifier, &res);
+	v8js_compile_script(getThis(), str, identifier, NULL, &res);
 	if (!res) {
 		RETURN_FALSE;
 	}
@@ -620,18 +891,18 @@ static PHP_METHOD(V8Js, executeString)
 /* }}} */
 
 
-/* {{{ proto mixed V8Js::compileString(string script [, string identifier])
+/* {{{ proto mixed V8Js::compileString(string script [, string identifier [, string code_cache]])
  */
 static PHP_METHOD(V8Js, compileString)
 {
-	zend_string *str = NULL, *identifier = NULL;
+	zend_string *str = NULL, *identifier = NULL, *code_cache = NULL;
 	v8js_script *res = NULL;
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS(), "S|S", &str, &identifier) == FAILURE) {
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "S|S!S!", &str, &identifier, &code_cache) == FAILURE) {
 		return;
 	}
 
-	v8js_compile_script(getThis(), str, identifier, &res);
+	v8js_compile_script(getThis(), str, identifier, code_cache, &res);
 	if (res) {
 		RETVAL_RES(zend_register_resource(res, le_v8js_script));
 
@@ -669,57 +940,167 @@ static PHP_METHOD(V8Js, executeScript)
 }
 /* }}} */
 
-/* {{{ proto void V8Js::setModuleNormaliser(string base, string module_id)
- */
-static PHP_METHOD(V8Js, setModuleNormaliser)
+static void v8js_create_code_cache(v8js_ctx *c, v8js_script *res, zval *return_value) /* {{{ */
 {
-	v8js_ctx *c;
-	zval *callable;
+	V8JS_CTX_PROLOGUE(c);
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z", &callable) == FAILURE) {
-		return;
+	/* Contains all functions compiled so far, i.e. the lazily compiled
+	 * ones too, if the script has already been executed. */
+	v8::Local<v8::Script> script = v8::Local<v8::Script>::New(isolate, *res->script);
+	v8::ScriptCompiler::CachedData *cache = v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript());
+
+	if (!cache) {
+		RETURN_FALSE;
 	}
 
-	c = Z_V8JS_CTX_OBJ_P(getThis());
-	ZVAL_COPY(&c->module_normaliser, callable);
+	RETVAL_STRINGL(reinterpret_cast<const char *>(cache->data), cache->length);
+	delete cache;
 }
 /* }}} */
 
-/* {{{ proto void V8Js::setModuleLoader(string module)
+/* {{{ proto string|false V8Js::createCodeCache(resource script)
  */
-static PHP_METHOD(V8Js, setModuleLoader)
+static PHP_METHOD(V8Js, createCodeCache)
 {
-	v8js_ctx *c;
-	zval *callable;
+	zval *zscript;
+	v8js_script *res;
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z", &callable) == FAILURE) {
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "r", &zscript) == FAILURE) {
 		return;
 	}
 
-	c = Z_V8JS_CTX_OBJ_P(getThis());
-	ZVAL_COPY(&c->module_loader, callable);
+	if((res = (v8js_script *)zend_fetch_resource(Z_RES_P(zscript), PHP_V8JS_SCRIPT_RES_NAME, le_v8js_script)) == NULL) {
+		RETURN_FALSE;
+	}
+
+	v8js_ctx *c = Z_V8JS_CTX_OBJ_P(getThis());
+	if (res->ctx != c) {
+		zend_error(E_WARNING, "Script resource from wrong V8Js object passed");
+		RETURN_FALSE;
+	}
+
+	v8js_create_code_cache(c, res, return_value);
 }
 /* }}} */
 
-/* {{{ proto void V8Js::setTimeLimit(int time_limit)
+/* {{{ proto string|false V8Js::createWarmCodeCache(string script, string identifier [, array entry_points])
  */
-static PHP_METHOD(V8Js, setTimeLimit)
+static PHP_METHOD(V8Js, createWarmCodeCache)
 {
-	v8js_ctx *c;
-	long time_limit = 0;
+	zend_string *str = NULL, *identifier = NULL;
+	HashTable *entry_points = NULL;
+	v8js_script *res = NULL;
+	zval retval, *entry_point;
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS(), "l", &time_limit) == FAILURE) {
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "SS|h", &str, &identifier, &entry_points) == FAILURE) {
 		return;
 	}
 
-	c = Z_V8JS_CTX_OBJ_P(getThis());
-	c->time_limit = time_limit;
-
-	V8JSG(timer_mutex).lock();
-	for (std::deque< v8js_timer_ctx* >::iterator it = V8JSG(timer_stack).begin();
-		 it != V8JSG(timer_stack).end(); it ++) {
-		if((*it)->ctx == c && !(*it)->killed) {
-			(*it)->time_limit = time_limit;
+	v8js_compile_script(getThis(), str, identifier, NULL, &res);
+	if (!res) {
+		RETURN_FALSE;
+	}
+
+	zend_try {
+		zval *retval_ptr = &retval;
+		ZVAL_UNDEF(&retval);
+
+		/* Run the script itself, then every entry point, so V8 compiles
+		 * the functions actually used */
+		v8js_execute_script(getThis(), res, V8JS_FLAG_NONE, 0, 0, &retval_ptr);
+		zval_ptr_dtor(&retval);
+
+		if (!EG(exception) && entry_points) {
+			ZEND_HASH_FOREACH_VAL(entry_points, entry_point) {
+				zend_string *entry_source = zval_get_string(entry_point);
+				v8js_script *entry_res = NULL;
+
+				v8js_compile_script(getThis(), entry_source, identifier, NULL, &entry_res);
+				zend_string_release(entry_source);
+
+				if (!entry_res) {
+					break;
+				}
+
+				ZVAL_UNDEF(&retval);
+				v8js_execute_script(getThis(), entry_res, V8JS_FLAG_NONE, 0, 0, &retval_ptr);
+				zval_ptr_dtor(&retval);
+				v8js_script_free(entry_res);
+				efree(entry_res);
+
+				if (EG(exception)) {
+					break;
+				}
+			} ZEND_HASH_FOREACH_END();
+		}
+
+		if (!EG(exception)) {
+			v8js_create_code_cache(Z_V8JS_CTX_OBJ_P(getThis()), res, return_value);
+		}
+
+		v8js_script_free(res);
+	}
+	zend_catch {
+		v8js_script_free(res);
+		zend_bailout();
+	}
+	zend_end_try()
+
+	efree(res);
+}
+/* }}} */
+
+/* {{{ proto void V8Js::setModuleNormaliser(string base, string module_id)
+ */
+static PHP_METHOD(V8Js, setModuleNormaliser)
+{
+	v8js_ctx *c;
+	zval *callable;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z", &callable) == FAILURE) {
+		return;
+	}
+
+	c = Z_V8JS_CTX_OBJ_P(getThis());
+	ZVAL_COPY(&c->module_normaliser, callable);
+}
+/* }}} */
+
+/* {{{ proto void V8Js::setModuleLoader(string module)
+ */
+static PHP_METHOD(V8Js, setModuleLoader)
+{
+	v8js_ctx *c;
+	zval *callable;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z", &callable) == FAILURE) {
+		return;
+	}
+
+	c = Z_V8JS_CTX_OBJ_P(getThis());
+	ZVAL_COPY(&c->module_loader, callable);
+}
+/* }}} */
+
+/* {{{ proto void V8Js::setTimeLimit(int time_limit)
+ */
+static PHP_METHOD(V8Js, setTimeLimit)
+{
+	v8js_ctx *c;
+	long time_limit = 0;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "l", &time_limit) == FAILURE) {
+		return;
+	}
+
+	c = Z_V8JS_CTX_OBJ_P(getThis());
+	c->time_limit = time_limit;
+
+	V8JSG(timer_mutex).lock();
+	for (std::deque< v8js_timer_ctx* >::iterator it = V8JSG(timer_stack).begin();
+		 it != V8JSG(timer_stack).end(); it ++) {
+		if((*it)->ctx == c && !(*it)->killed) {
+			(*it)->time_limit = time_limit;
 
 			// Calculate the time point when the time limit is exceeded
 			std::chrono::milliseconds duration(time_limit);
@@ -790,6 +1171,314 @@ static PHP_METHOD(V8Js, setAverageObjectSize)
 }
 /* }}} */
 
+/* {{{ proto array V8Js::drainConsole()
+ */
+static PHP_METHOD(V8Js, drainConsole)
+{
+	v8js_ctx *c;
+
+	if (zend_parse_parameters_none() == FAILURE) {
+		return;
+	}
+
+	c = Z_V8JS_CTX_OBJ_P(getThis());
+	v8js_console_drain(c, return_value);
+}
+/* }}} */
+
+/* {{{ proto array V8Js::getCallbackProfile([int limit = 20 [, bool reset = false]])
+ */
+static PHP_METHOD(V8Js, getCallbackProfile)
+{
+	v8js_ctx *c;
+	zend_long limit = 20;
+	zend_bool reset = 0;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "|lb", &limit, &reset) == FAILURE) {
+		return;
+	}
+
+	c = Z_V8JS_CTX_OBJ_P(getThis());
+	v8js_profile_to_array(c, limit, return_value);
+
+	if (reset) {
+		c->callback_profile.clear();
+	}
+}
+/* }}} */
+
+/* Objects V8Object instances within a PHP value refer to are live objects of
+ * the script (not created by the conversion), mark them to be left alone. */
+static void v8js_collect_v8objects(v8::Isolate *isolate, v8::Local<v8::Context> v8_context, zval *value, v8::Local<v8::Set> visited) /* {{{ */
+{
+	ZVAL_DEREF(value);
+
+	if (Z_TYPE_P(value) == IS_OBJECT) {
+		zend_class_entry *ce = Z_OBJCE_P(value);
+
+		if (ce == php_ce_v8function || ce == php_ce_v8object || ce == php_ce_v8generator) {
+			v8js_v8object *obj = Z_V8JS_V8OBJECT_OBJ_P(value);
+
+			if (obj->ctx && obj->ctx->isolate == isolate) {
+				if (visited->Add(v8_context, v8::Local<v8::Value>::New(isolate, obj->v8obj)).IsEmpty()) {
+					return;
+				}
+			}
+		}
+
+		/* Other PHP objects are wrapped, freezing doesn't descend into them */
+		return;
+	}
+
+	if (Z_TYPE_P(value) != IS_ARRAY) {
+		return;
+	}
+
+	HashTable *myht = Z_ARRVAL_P(value);
+
+	if (GC_IS_RECURSIVE(myht)) {
+		return;
+	}
+
+	if (!(GC_FLAGS(myht) & GC_IMMUTABLE)) {
+		GC_PROTECT_RECURSION(myht);
+	}
+
+	zval *data;
+
+	ZEND_HASH_FOREACH_VAL(myht, data) {
+		v8js_collect_v8objects(isolate, v8_context, data, visited);
+	} ZEND_HASH_FOREACH_END();
+
+	if (!(GC_FLAGS(myht) & GC_IMMUTABLE)) {
+		GC_UNPROTECT_RECURSION(myht);
+	}
+}
+/* }}} */
+
+/* Freeze value including all nested objects, except for those already in
+ * visited (i.e. seen before or live objects from the script).  Wrapped PHP
+ * objects are live-bound (and hence skipped), TypedArrays can't be frozen. */
+static void v8js_deep_freeze(v8::Isolate *isolate, v8::Local<v8::Context> v8_context, v8::Local<v8::Value> value, v8::Local<v8::Set> visited) /* {{{ */
+{
+	if (!value->IsObject() || value->IsFunction() || value->IsArrayBufferView()) {
+		return;
+	}
+
+	v8::Local<v8::Object> obj = value.As<v8::Object>();
+	v8::Local<v8::Array> names;
+
+	if (obj->InternalFieldCount() == 2 || visited->Has(v8_context, obj).FromMaybe(true)) {
+		return;
+	}
+
+	/* Before descending, so cycles end here */
+	if (visited->Add(v8_context, obj).IsEmpty()) {
+		return;
+	}
+
+	if (obj->GetOwnPropertyNames(v8_context).ToLocal(&names)) {
+		for (uint32_t i = 0; i < names->Length(); i ++) {
+			v8::Local<v8::Value> name, child;
+
+			if (names->Get(v8_context, i).ToLocal(&name) && obj->Get(v8_context, name).ToLocal(&child)) {
+				v8js_deep_freeze(isolate, v8_context, child, visited);
+			}
+		}
+	}
+
+	obj->SetIntegrityLevel(v8_context, v8::IntegrityLevel::kFrozen);
+}
+/* }}} */
+
+/* Install value as read-only, non-deletable global */
+static bool v8js_define_constant(v8::Isolate *isolate, v8::Local<v8::Context> v8_context, zend_string *name, v8::Local<v8::Value> value) /* {{{ */
+{
+	v8::Local<v8::Name> key = V8JS_SYML(ZSTR_VAL(name), static_cast<int>(ZSTR_LEN(name)));
+
+	return v8_context->Global()->DefineOwnProperty(v8_context, key, value,
+		static_cast<v8::PropertyAttribute>(v8::ReadOnly | v8::DontDelete)).FromMaybe(false);
+}
+/* }}} */
+
+/* {{{ proto void V8Js::bindGlobals(array values [, int mode = V8Js::BIND_COPY])
+ */
+static PHP_METHOD(V8Js, bindGlobals)
+{
+	HashTable *values;
+	zend_long mode = V8JS_BIND_COPY;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "h|l", &values, &mode) == FAILURE) {
+		return;
+	}
+
+	V8JS_BEGIN_CTX(c, getThis())
+	v8js_bind_globals(c, values, static_cast<int>(mode), isolate);
+}
+/* }}} */
+
+/* {{{ proto void V8Js::defineConstant(string name, mixed value)
+ */
+static PHP_METHOD(V8Js, defineConstant)
+{
+	zend_string *name;
+	zval *value;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "Sz", &name, &value) == FAILURE) {
+		return;
+	}
+
+	if (ZSTR_LEN(name) > std::numeric_limits<int>::max()) {
+		zend_throw_exception(php_ce_v8js_exception,
+			"Constant name exceeds maximum supported length", 0);
+		return;
+	}
+
+	V8JS_BEGIN_CTX(c, getThis())
+
+	v8::Local<v8::Value> js_value = zval_to_v8js(value, isolate);
+
+	if (EG(exception)) {
+		return;
+	}
+
+	/* Only what the conversion created is frozen, not the script's objects */
+	v8::Local<v8::Set> visited = v8::Set::New(isolate);
+	v8js_collect_v8objects(isolate, v8_context, value, visited);
+	v8js_deep_freeze(isolate, v8_context, js_value, visited);
+
+	if (!v8js_define_constant(isolate, v8_context, name, js_value)) {
+		zend_throw_exception_ex(php_ce_v8js_exception, 0, "Cannot redefine constant '%s'", ZSTR_VAL(name));
+	}
+}
+/* }}} */
+
+static void v8js_typed_array_method(INTERNAL_FUNCTION_PARAMETERS, int type) /* {{{ */
+{
+	HashTable *values;
+	v8::Local<v8::Value> typed_array;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "h", &values) == FAILURE) {
+		return;
+	}
+
+	V8JS_BEGIN_CTX(c, getThis())
+
+	if (!v8js_hash_to_typed_array(values, type, isolate).ToLocal(&typed_array)) {
+		zend_throw_exception(php_ce_v8js_exception, type == V8JS_TYPED_ARRAY_INT32
+			? "Array must be a list of integers in 32-bit range"
+			: "Array must be a list of integers or floats", 0);
+		return;
+	}
+
+	v8js_v8object_create(return_value, typed_array, c->flags, isolate);
+}
+/* }}} */
+
+/* {{{ proto V8Object V8Js::float64Array(array values)
+ */
+static PHP_METHOD(V8Js, float64Array)
+{
+	v8js_typed_array_method(INTERNAL_FUNCTION_PARAM_PASSTHRU, V8JS_TYPED_ARRAY_FLOAT64);
+}
+/* }}} */
+
+/* {{{ proto V8Object V8Js::int32Array(array values)
+ */
+static PHP_METHOD(V8Js, int32Array)
+{
+	v8js_typed_array_method(INTERNAL_FUNCTION_PARAM_PASSTHRU, V8JS_TYPED_ARRAY_INT32);
+}
+/* }}} */
+
+/* {{{ proto V8Function V8Js::async(callable callback)
+ */
+static PHP_METHOD(V8Js, async)
+{
+	zval *callable;
+	v8::Local<v8::Function> fn;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z", &callable) == FAILURE) {
+		return;
+	}
+
+#if PHP_VERSION_ID < 80100
+	zend_throw_exception(php_ce_v8js_exception, "Async callbacks require Fibers (PHP 8.1+)", 0);
+	return;
+#endif
+
+	if (!zend_is_callable(callable, 0, NULL)) {
+		zend_throw_exception(php_ce_v8js_exception, "Async callback must be callable", 0);
+		return;
+	}
+
+	V8JS_BEGIN_CTX(c, getThis())
+
+	if (!v8js_async_function(c, callable, isolate).ToLocal(&fn)) {
+		return;
+	}
+
+	v8js_v8object_create(return_value, fn, c->flags, isolate);
+}
+/* }}} */
+
+/* {{{ proto void V8Js::setAsyncWait(?callable wait)
+ */
+static PHP_METHOD(V8Js, setAsyncWait)
+{
+	v8js_ctx *c;
+	zval *callable;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z!", &callable) == FAILURE) {
+		return;
+	}
+
+	if (callable && !zend_is_callable(callable, 0, NULL)) {
+		zend_throw_exception(php_ce_v8js_exception, "Async wait function must be callable", 0);
+		return;
+	}
+
+	c = Z_V8JS_CTX_OBJ_P(getThis());
+	zval_ptr_dtor(&c->async_wait);
+
+	if (callable) {
+		ZVAL_COPY(&c->async_wait, callable);
+	} else {
+		ZVAL_NULL(&c->async_wait);
+	}
+}
+/* }}} */
+
+/* {{{ proto void V8Js::registerBatchLoader(string name, callable batch_function)
+ */
+static PHP_METHOD(V8Js, registerBatchLoader)
+{
+	zend_string *name;
+	zval *callable;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "Sz", &name, &callable) == FAILURE) {
+		return;
+	}
+
+	if (ZSTR_LEN(name) > std::numeric_limits<int>::max()) {
+		zend_throw_exception(php_ce_v8js_exception,
+			"Loader name length exceeds maximum supported length", 0);
+		return;
+	}
+
+	if (!zend_is_callable(callable, 0, NULL)) {
+		zend_throw_exception(php_ce_v8js_exception, "Batch function must be callable", 0);
+		return;
+	}
+
+	V8JS_BEGIN_CTX(c, getThis())
+
+	if (!v8js_batch_loader_register(c, name, callable, isolate)) {
+		zend_throw_exception_ex(php_ce_v8js_exception, 0, "Cannot register batch loader '%s'", ZSTR_VAL(name));
+	}
+}
+/* }}} */
+
 static void v8js_persistent_zval_ctor(zval *p) /* {{{ */
 {
 	assert(Z_TYPE_P(p) == IS_STRING);
@@ -832,7 +1521,38 @@ static void v8js_script_dtor(zend_resource *rsrc) /* {{{ */
 
 /* ## Static methods ## */
 
-static v8::StartupData createSnapshotDataBlob(v8::SnapshotCreator *snapshot_creator, zend_string *str) /* {{{ */
+/* Constants are passed JSON encoded (see V8Js::createSnapshot), as only plain
+ * data can be embedded into a snapshot */
+static bool v8js_snapshot_define_constants(v8::Isolate *isolate, v8::Local<v8::Context> context, HashTable *constants) /* {{{ */
+{
+	zend_string *name;
+	zval *json;
+
+	if (!constants) {
+		return true;
+	}
+
+	v8::Local<v8::Set> visited = v8::Set::New(isolate);
+
+	ZEND_HASH_FOREACH_STR_KEY_VAL(constants, name, json) {
+		v8::Local<v8::Value> value;
+
+		if (!v8::JSON::Parse(context, V8JS_ZSTR(Z_STR_P(json))).ToLocal(&value)) {
+			return false;
+		}
+
+		v8js_deep_freeze(isolate, context, value, visited);
+
+		if (!v8js_define_constant(isolate, context, name, value)) {
+			return false;
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	return true;
+}
+/* }}} */
+
+static v8::StartupData createSnapshotDataBlob(v8::SnapshotCreator *snapshot_creator, zend_string *str, HashTable *constants) /* {{{ */
 {
 	v8::Isolate *isolate = snapshot_creator->GetIsolate();
 
@@ -843,6 +1563,10 @@ static v8::StartupData createSnapshotDataBlob(v8::SnapshotCreator *snapshot_crea
 		v8::Context::Scope context_scope(context);
 		v8::TryCatch try_catch(isolate);
 
+		if (!v8js_snapshot_define_constants(isolate, context, constants)) {
+			return {nullptr, 0};
+		}
+
 		v8::Local<v8::String> source = V8JS_ZSTR(str);
 		v8::MaybeLocal<v8::Script> script = v8::Script::Compile(context, source);
 
@@ -858,44 +1582,202 @@ static v8::StartupData createSnapshotDataBlob(v8::SnapshotCreator *snapshot_crea
 } /* }}} */
 
 
-/* {{{ proto string|bool V8Js::createSnapshot(string embed_source)
+static v8::StartupData createMultiContextSnapshotDataBlob(v8::SnapshotCreator *snapshot_creator, HashTable *sources, HashTable *constants, smart_str *header) /* {{{ */
+{
+	v8::Isolate *isolate = snapshot_creator->GetIsolate();
+	zend_string *name;
+	zval *source;
+	uint32_t count = zend_hash_num_elements(sources);
+
+	smart_str_appendl(header, V8JS_SNAPSHOT_MAGIC, V8JS_SNAPSHOT_MAGIC_LEN);
+	smart_str_appendl(header, reinterpret_cast<const char *>(&count), sizeof(count));
+
+	{
+		v8::HandleScope scope(isolate);
+
+		/* The default context stays empty */
+		snapshot_creator->SetDefaultContext(v8::Context::New(isolate));
+
+		ZEND_HASH_FOREACH_STR_KEY_VAL(sources, name, source) {
+			if (!name || Z_TYPE_P(source) != IS_STRING || Z_STRLEN_P(source) > std::numeric_limits<int>::max()) {
+				return {nullptr, 0};
+			}
+
+			v8::Local<v8::Context> context = v8::Context::New(isolate);
+			v8::Context::Scope context_scope(context);
+			v8::TryCatch try_catch(isolate);
+
+			if (!v8js_snapshot_define_constants(isolate, context, constants)) {
+				return {nullptr, 0};
+			}
+
+			v8::MaybeLocal<v8::Script> script = v8::Script::Compile(context, V8JS_ZSTR(Z_STR_P(source)));
+
+			if (script.IsEmpty() || script.ToLocalChecked()->Run(context).IsEmpty()) {
+				return {nullptr, 0};
+			}
+
+			uint32_t index = static_cast<uint32_t>(snapshot_creator->AddContext(context));
+			uint32_t name_len = static_cast<uint32_t>(ZSTR_LEN(name));
+
+			smart_str_appendl(header, reinterpret_cast<const char *>(&index), sizeof(index));
+			smart_str_appendl(header, reinterpret_cast<const char *>(&name_len), sizeof(name_len));
+			smart_str_appendl(header, ZSTR_VAL(name), ZSTR_LEN(name));
+		} ZEND_HASH_FOREACH_END();
+	}
+
+	/* V8's blob follows 8 byte aligned */
+	while (ZSTR_LEN(header->s) % 8) {
+		smart_str_appendc(header, '\0');
+	}
+
+	return snapshot_creator->CreateBlob(v8::SnapshotCreator::FunctionCodeHandling::kClear);
+} /* }}} */
+
+
+/* {{{ proto string|bool V8Js::createSnapshot(string|array embed_source [, ?array constants])
  */
 static PHP_METHOD(V8Js, createSnapshot)
 {
-	zend_string *script;
+	zval *embed_source;
+	HashTable *constants = NULL;
+	smart_str header = {0};
 
-	if (zend_parse_parameters(ZEND_NUM_ARGS(), "S", &script) == FAILURE) {
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z|h!", &embed_source, &constants) == FAILURE) {
 		return;
 	}
 
-	if (!ZSTR_LEN(script)) {
-		php_error_docref(NULL, E_WARNING, "Script cannot be empty");
-		RETURN_FALSE;
+	if (Z_TYPE_P(embed_source) == IS_ARRAY) {
+		if (!zend_hash_num_elements(Z_ARRVAL_P(embed_source))) {
+			php_error_docref(NULL, E_WARNING, "Sources cannot be empty");
+			RETURN_FALSE;
+		}
+	} else {
+		if (!try_convert_to_string(embed_source)) {
+			return;
+		}
+
+		if (!Z_STRLEN_P(embed_source)) {
+			php_error_docref(NULL, E_WARNING, "Script cannot be empty");
+			RETURN_FALSE;
+		}
+	}
+
+	/* Encode constants upfront, so errors are reported before V8 is involved */
+	zval encoded;
+	ZVAL_UNDEF(&encoded);
+
+	if (constants) {
+		zend_string *name;
+		zval *value;
+
+		array_init_size(&encoded, zend_hash_num_elements(constants));
+
+		ZEND_HASH_FOREACH_STR_KEY_VAL(constants, name, value) {
+			smart_str json = {0};
+
+			if (!name || ZSTR_LEN(name) > std::numeric_limits<int>::max()) {
+				zval_ptr_dtor(&encoded);
+				zend_argument_value_error(2, "must be an array with string keys");
+				return;
+			}
+
+			if (php_json_encode(&json, value, 0) == FAILURE) {
+				smart_str_free(&json);
+				zval_ptr_dtor(&encoded);
+				php_error_docref(NULL, E_WARNING, "Constant '%s' cannot be encoded as JSON", ZSTR_VAL(name));
+				RETURN_FALSE;
+			}
+
+			add_assoc_str_ex(&encoded, ZSTR_VAL(name), ZSTR_LEN(name), smart_str_extract(&json));
+		} ZEND_HASH_FOREACH_END();
 	}
 
+	HashTable *encoded_constants = Z_TYPE(encoded) == IS_ARRAY ? Z_ARRVAL(encoded) : NULL;
+
 	/* Initialize V8, if not already done. */
 	v8js_v8_init();
 
 	v8::Isolate *isolate = v8::Isolate::Allocate();
 	v8::SnapshotCreator snapshot_creator(isolate);
-	v8::StartupData snapshot_blob = createSnapshotDataBlob(&snapshot_creator, script);
+	v8::StartupData snapshot_blob = Z_TYPE_P(embed_source) == IS_ARRAY
+		? createMultiContextSnapshotDataBlob(&snapshot_creator, Z_ARRVAL_P(embed_source), encoded_constants, &header)
+		: createSnapshotDataBlob(&snapshot_creator, Z_STR_P(embed_source), encoded_constants);
+
+	zval_ptr_dtor(&encoded);
 
 	if (!snapshot_blob.data) {
+		smart_str_free(&header);
 		php_error_docref(NULL, E_WARNING, "Failed to create V8 heap snapshot.  Check $embed_source for errors.");
 		RETURN_FALSE;
 	}
 
-	RETVAL_STRINGL(snapshot_blob.data, snapshot_blob.raw_size);
+	if (header.s) {
+		smart_str_appendl(&header, snapshot_blob.data, snapshot_blob.raw_size);
+		RETVAL_STR(smart_str_extract(&header));
+	} else {
+		RETVAL_STRINGL(snapshot_blob.data, snapshot_blob.raw_size);
+	}
 	delete[] snapshot_blob.data;
 }
 /* }}} */
 
+/* {{{ proto bool V8Js::startTracing(string path [, string categories])
+ */
+static PHP_METHOD(V8Js, startTracing)
+{
+	zend_string *path, *categories = NULL;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "P|S!", &path, &categories) == FAILURE) {
+		return;
+	}
+
+	/* Initialize V8, if not already done. */
+	v8js_v8_init();
+
+	if (!v8js_tracing_start(ZSTR_VAL(path), categories ? ZSTR_VAL(categories) : INI_STR("v8js.trace_categories"))) {
+		return;
+	}
+
+	V8JSG(tracing_started) = true;
+	RETURN_TRUE;
+}
+/* }}} */
+
+/* {{{ proto bool V8Js::stopTracing()
+ */
+static PHP_METHOD(V8Js, stopTracing)
+{
+	if (zend_parse_parameters_none() == FAILURE) {
+		return;
+	}
+
+	V8JSG(tracing_started) = false;
+	RETURN_BOOL(v8js_tracing_stop());
+}
+/* }}} */
+
+/* {{{ proto int V8Js::prewarm([int count])
+ */
+static PHP_METHOD(V8Js, prewarm)
+{
+	zend_long count = INI_INT("v8js.prewarm_count");
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "|l", &count) == FAILURE) {
+		return;
+	}
+
+	RETURN_LONG(static_cast<zend_long>(v8js_prewarm_fill(count)));
+}
+/* }}} */
+
 
 /* {{{ arginfo */
 ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_construct, 0, 0, 0)
 	ZEND_ARG_INFO(0, object_name)
 	ZEND_ARG_INFO(0, variables)
 	ZEND_ARG_INFO(0, snapshot_blob)
+	ZEND_ARG_INFO(0, snapshot_context)
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_INFO(arginfo_v8js_sleep, 0)
@@ -915,6 +1797,7 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_compilestring, 0, 0, 1)
 	ZEND_ARG_INFO(0, script)
 	ZEND_ARG_INFO(0, identifier)
+	ZEND_ARG_INFO(0, code_cache)
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_executescript, 0, 0, 1)
@@ -924,6 +1807,16 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_executescript, 0, 0, 1)
 	ZEND_ARG_INFO(0, memory_limit)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_createcodecache, 0, 0, 1)
+	ZEND_ARG_INFO(0, script)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_createwarmcodecache, 0, 0, 2)
+	ZEND_ARG_INFO(0, script)
+	ZEND_ARG_INFO(0, identifier)
+	ZEND_ARG_INFO(0, entry_points)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_checkstring, 0, 0, 1)
 	ZEND_ARG_INFO(0, script)
 ZEND_END_ARG_INFO()
@@ -941,8 +1834,56 @@ ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_setaverageobjectsize, 0, 0, 1)
 	ZEND_ARG_INFO(0, average_object_size)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO(arginfo_v8js_drainconsole, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_getcallbackprofile, 0, 0, 0)
+	ZEND_ARG_INFO(0, limit)
+	ZEND_ARG_INFO(0, reset)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_bindglobals, 0, 0, 1)
+	ZEND_ARG_ARRAY_INFO(0, values, 0)
+	ZEND_ARG_INFO(0, mode)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_defineconstant, 0, 0, 2)
+	ZEND_ARG_INFO(0, name)
+	ZEND_ARG_INFO(0, value)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_typedarray, 0, 0, 1)
+	ZEND_ARG_ARRAY_INFO(0, values, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_async, 0, 0, 1)
+	ZEND_ARG_INFO(0, callback)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_setasyncwait, 0, 0, 1)
+	ZEND_ARG_INFO(0, wait)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_registerbatchloader, 0, 0, 2)
+	ZEND_ARG_INFO(0, name)
+	ZEND_ARG_INFO(0, batch_function)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_createsnapshot, 0, 0, 1)
 	ZEND_ARG_INFO(0, script)
+	ZEND_ARG_ARRAY_INFO(0, constants, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_starttracing, 0, 0, 1)
+	ZEND_ARG_INFO(0, path)
+	ZEND_ARG_INFO(0, categories)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO(arginfo_v8js_stoptracing, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_prewarm, 0, 0, 0)
+	ZEND_ARG_INFO(0, count)
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_v8js_settimelimit, 0, 0, 1)
@@ -961,12 +1902,26 @@ const zend_function_entry v8js_methods[] = { /* {{{ */
 	PHP_ME(V8Js,	executeString,			arginfo_v8js_executestring,			ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,	compileString,			arginfo_v8js_compilestring,			ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,    executeScript,			arginfo_v8js_executescript,			ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	createCodeCache,		arginfo_v8js_createcodecache,		ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	createWarmCodeCache,	arginfo_v8js_createwarmcodecache,	ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,	setModuleNormaliser,	arginfo_v8js_setmodulenormaliser,	ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,	setModuleLoader,		arginfo_v8js_setmoduleloader,		ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,	setTimeLimit,			arginfo_v8js_settimelimit,			ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,	setMemoryLimit,			arginfo_v8js_setmemorylimit,		ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,	setAverageObjectSize,	arginfo_v8js_setaverageobjectsize,	ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	drainConsole,			arginfo_v8js_drainconsole,			ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	getCallbackProfile,		arginfo_v8js_getcallbackprofile,	ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	bindGlobals,			arginfo_v8js_bindglobals,			ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	defineConstant,			arginfo_v8js_defineconstant,		ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	float64Array,			arginfo_v8js_typedarray,			ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	int32Array,				arginfo_v8js_typedarray,			ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	async,					arginfo_v8js_async,					ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	setAsyncWait,			arginfo_v8js_setasyncwait,			ZEND_ACC_PUBLIC)
+	PHP_ME(V8Js,	registerBatchLoader,	arginfo_v8js_registerbatchloader,	ZEND_ACC_PUBLIC)
 	PHP_ME(V8Js,	createSnapshot,			arginfo_v8js_createsnapshot,		ZEND_ACC_PUBLIC|ZEND_ACC_STATIC)
+	PHP_ME(V8Js,	startTracing,			arginfo_v8js_starttracing,			ZEND_ACC_PUBLIC|ZEND_ACC_STATIC)
+	PHP_ME(V8Js,	stopTracing,			arginfo_v8js_stoptracing,			ZEND_ACC_PUBLIC|ZEND_ACC_STATIC)
+	PHP_ME(V8Js,	prewarm,				arginfo_v8js_prewarm,				ZEND_ACC_PUBLIC|ZEND_ACC_STATIC)
 	{NULL, NULL, NULL}
 };
 /* }}} */
@@ -1049,6 +2004,12 @@ PHP_MINIT_FUNCTION(v8js_class) /* {{{ */
 	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("FLAG_NONE"),			V8JS_FLAG_NONE);
 	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("FLAG_FORCE_ARRAY"),	V8JS_FLAG_FORCE_ARRAY);
 	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("FLAG_PROPAGATE_PHP_EXCEPTIONS"), V8JS_FLAG_PROPAGATE_PHP_EXCEPTIONS);
+	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("FLAG_TYPED_ARRAYS"),	V8JS_FLAG_TYPED_ARRAYS);
+	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("FLAG_AWAIT"),			V8JS_FLAG_AWAIT);
+
+	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("BIND_COPY"),			V8JS_BIND_COPY);
+	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("BIND_REFERENCE"),		V8JS_BIND_REFERENCE);
+	zend_declare_class_constant_long(php_ce_v8js, ZEND_STRL("BIND_TRACKED"),		V8JS_BIND_TRACKED);
 
 	le_v8js_script = zend_register_list_destructors_ex(v8js_script_dtor, NULL, PHP_V8JS_SCRIPT_RES_NAME, module_number);
 
@@ -25,8 +25,42 @@ typedef v8::Persistent<v8::Value, v8::CopyablePersistentTraits<v8::Value> > v8js
 /* Forward declarations */
 struct v8js_v8object;
 struct v8js_accessor_ctx;
+struct v8js_global_binding;
+struct v8js_php_iterator;
+struct v8js_async_job;
+struct v8js_batch_loader;
 struct _v8js_script;
 
+/* Buffered console output line, see v8js_console.cc */
+struct v8js_console_entry {
+	int type;
+	std::string message;
+};
+
+/* Memoized call result, see v8js_memoize.cc */
+struct v8js_memo_entry {
+	zval result;
+	std::list<const std::string *>::iterator lru;
+};
+
+/* Number of histogram buckets of the callback profiler, see v8js_profiler.cc */
+#define V8JS_PROFILE_BUCKETS 24
+
+/* Per-callback statistics of the callback profiler */
+struct v8js_callback_stats {
+	uint64_t calls;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t histogram[V8JS_PROFILE_BUCKETS];
+};
+
+/* Public properties & methods of a V8Js (sub)class exported by __construct,
+ * computed once per class and request, see v8js_get_export_plan() */
+struct v8js_export_plan {
+	std::vector<zend_property_info *> properties;
+	std::vector<zend_function *> methods;
+};
+
 struct cmp_str {
     bool operator()(char const *a, char const *b) const {
         return strcmp(a, b) < 0;
@@ -53,12 +87,18 @@ struct v8js_ctx {
 
   zval module_normaliser;
   zval module_loader;
+  zval async_wait;
 
   std::vector<char *> modules_stack;
   std::map<char *, v8js_persistent_value_t, cmp_str> modules_loaded;
   std::map<const zend_string *,v8js_function_tmpl_t> template_cache;
 
   std::map<zend_object *, v8js_persistent_obj_t> weak_objects;
+  std::unordered_map<zend_object *, v8js_persistent_obj_t> enum_cases;
+  v8js_function_tmpl_t iterator_tmpl;
+  std::list<v8js_php_iterator *> php_iterators;
+  std::unordered_map<HashTable *, v8js_persistent_value_t> immutable_arrays;
+  uint32_t immutable_arrays_generation;
   std::map<v8js_function_tmpl_t *, v8js_persistent_obj_t> weak_closures;
   std::map<v8js_function_tmpl_t *, v8js_function_tmpl_t> call_impls;
   std::map<std::pair<zend_class_entry *, zend_function *>, v8js_function_tmpl_t> method_tmpls;
@@ -66,7 +106,22 @@ struct v8js_ctx {
   std::list<v8js_v8object *> v8js_v8objects;
 
   std::vector<v8js_accessor_ctx *> accessor_list;
+  std::map<std::string, v8js_global_binding *> global_bindings;
   std::vector<struct _v8js_script *> script_objects;
+
+  std::list<v8js_async_job *> async_jobs;
+  std::vector<zval *> async_callables;
+  bool async_running;
+  std::vector<v8js_batch_loader *> batch_loaders;
+
+  std::deque<v8js_console_entry> console_buffer;
+  size_t console_dropped;
+
+  std::unordered_map<std::string, v8js_memo_entry> memo_cache;
+  std::list<const std::string *> memo_lru;
+  int memo_next_id;
+
+  std::unordered_map<std::string, v8js_callback_stats> callback_profile;
   char *tz;
 
   v8::Isolate::CreateParams create_params;
@@ -0,0 +1,255 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_console.h"
+
+static const struct {
+	const char *name;
+	int level;
+} v8js_console_methods[] = {
+	{ "debug",	V8JS_CONSOLE_DEBUG },
+	{ "trace",	V8JS_CONSOLE_DEBUG },
+	{ "log",	V8JS_CONSOLE_INFO },
+	{ "info",	V8JS_CONSOLE_INFO },
+	{ "warn",	V8JS_CONSOLE_WARN },
+	{ "error",	V8JS_CONSOLE_ERROR },
+};
+
+static const char *v8js_console_level_names[] = { "debug", "info", "warn", "error", "none" };
+
+int v8js_console_parse_level(const char *str, size_t len) /* {{{ */
+{
+	for (int i = V8JS_CONSOLE_DEBUG; i <= V8JS_CONSOLE_NONE; i ++) {
+		if (strlen(v8js_console_level_names[i]) == len && strncasecmp(str, v8js_console_level_names[i], len) == 0) {
+			return i;
+		}
+	}
+
+	if (len == 3 && strncasecmp(str, "log", len) == 0) {
+		return V8JS_CONSOLE_INFO;
+	}
+
+	int level = atoi(str);
+	return level < V8JS_CONSOLE_DEBUG ? V8JS_CONSOLE_DEBUG : level > V8JS_CONSOLE_NONE ? V8JS_CONSOLE_NONE : level;
+}
+/* }}} */
+
+static void v8js_console_append_string(v8::Isolate *isolate, v8::Local<v8::Value> value, std::string &out) /* {{{ */
+{
+	v8::String::Utf8Value str(isolate, value);
+
+	if (*str) {
+		out.append(*str, str.length());
+	}
+}
+/* }}} */
+
+/* Append a value to the line; objects are JSON encoded (as %o would do),
+ * everything else uses its string representation. */
+static void v8js_console_append_value(v8::Isolate *isolate, v8::Local<v8::Context> v8_context, v8::Local<v8::Value> value, std::string &out, bool inspect) /* {{{ */
+{
+	v8::TryCatch try_catch(isolate); /* toString() and JSON.stringify() might throw */
+	v8::Local<v8::String> str;
+
+	if (value->IsString() && !inspect) {
+		v8js_console_append_string(isolate, value, out);
+		return;
+	}
+
+	if (value->IsNativeError()) {
+		v8::Local<v8::Value> stack;
+
+		if (value.As<v8::Object>()->Get(v8_context, V8JS_SYM("stack")).ToLocal(&stack) && stack->IsString()) {
+			v8js_console_append_string(isolate, stack, out);
+			return;
+		}
+	}
+	else if (value->IsObject() && !value->IsFunction() && !value->IsRegExp() && !value->IsDate()) {
+		if (v8::JSON::Stringify(v8_context, value).ToLocal(&str) && !try_catch.HasCaught()) {
+			v8js_console_append_string(isolate, str, out);
+			return;
+		}
+
+		try_catch.Reset();
+	}
+	else if (value->IsString()) {
+		if (v8::JSON::Stringify(v8_context, value).ToLocal(&str)) {
+			v8js_console_append_string(isolate, str, out);
+			return;
+		}
+	}
+
+	if (value->ToDetailString(v8_context).ToLocal(&str)) {
+		v8js_console_append_string(isolate, str, out);
+	}
+	else {
+		out.append("<toString threw exception>");
+	}
+}
+/* }}} */
+
+/* Format console arguments like browsers do, i.e. with printf-like
+ * substitutions if the first argument is a string. */
+static void v8js_console_format(const v8::FunctionCallbackInfo<v8::Value>& info, std::string &out) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	int argc = info.Length(), i = 0;
+
+	if (argc > 0 && info[0]->IsString()) {
+		v8::String::Utf8Value fmt(isolate, info[0]);
+		const char *p = ToCString(fmt), *end = p + fmt.length();
+		i = 1;
+
+		while (p < end) {
+			const char *pct = static_cast<const char *>(memchr(p, '%', end - p));
+
+			if (pct == NULL || pct + 1 >= end) {
+				out.append(p, end - p);
+				break;
+			}
+
+			out.append(p, pct - p);
+			p = pct + 2;
+
+			switch (pct[1]) {
+				case '%':
+					out.append("%");
+					break;
+
+				case 's':
+				case 'd':
+				case 'i':
+				case 'f':
+				case 'o':
+				case 'O':
+				case 'j':
+				case 'c':
+					if (i >= argc) {
+						/* no argument left, keep placeholder as is */
+						out.append(pct, 2);
+						break;
+					}
+
+					if (pct[1] == 'd' || pct[1] == 'i' || pct[1] == 'f') {
+						double number = info[i]->NumberValue(v8_context).FromMaybe(std::nan(""));
+
+						if (pct[1] != 'f' && std::isfinite(number)) {
+							number = std::trunc(number);
+						}
+
+						v8js_console_append_value(isolate, v8_context, V8JS_FLOAT(number), out, false);
+					}
+					else if (pct[1] != 'c') {
+						/* %c is CSS styling, just swallow the argument */
+						v8js_console_append_value(isolate, v8_context, info[i], out, pct[1] != 's');
+					}
+
+					i ++;
+					break;
+
+				default:
+					out.append(pct, 2);
+					break;
+			}
+		}
+	}
+
+	for (; i < argc; i ++) {
+		if (i > 0) {
+			out.append(" ");
+		}
+
+		v8js_console_append_value(isolate, v8_context, info[i], out, false);
+	}
+}
+/* }}} */
+
+/* console.{debug,trace,log,info,warn,error} */
+static void v8js_console_method(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8js_ctx *c = (v8js_ctx *) isolate->GetData(0);
+	int type = info.Data().As<v8::Int32>()->Value();
+
+	/* Filter before formatting, so disabled levels are (almost) free */
+	if (v8js_console_methods[type].level < V8JSG(console_level) || V8JSG(console_buffer_size) <= 0) {
+		return;
+	}
+
+	if (c->console_buffer.size() >= static_cast<size_t>(V8JSG(console_buffer_size))) {
+		/* Ring buffer semantics, drop oldest line */
+		c->console_buffer.pop_front();
+		c->console_dropped ++;
+	}
+
+	c->console_buffer.emplace_back();
+	v8js_console_entry &entry = c->console_buffer.back();
+	entry.type = type;
+	v8js_console_format(info, entry.message);
+}
+/* }}} */
+
+void v8js_register_console(v8::Local<v8::ObjectTemplate> global, v8::Isolate *isolate) /* {{{ */
+{
+	v8::Local<v8::ObjectTemplate> console = v8::ObjectTemplate::New(isolate);
+
+	for (size_t i = 0; i < sizeof(v8js_console_methods) / sizeof(v8js_console_methods[0]); i ++) {
+		console->Set(V8JS_SYML(v8js_console_methods[i].name, static_cast<int>(strlen(v8js_console_methods[i].name))),
+			v8::FunctionTemplate::New(isolate, v8js_console_method, V8JS_INT(static_cast<int>(i))));
+	}
+
+	/* Not read-only, so scripts can still install their own console */
+	global->Set(V8JS_SYM("console"), console, v8::DontEnum);
+}
+/* }}} */
+
+void v8js_console_drain(v8js_ctx *c, zval *return_value) /* {{{ */
+{
+	array_init_size(return_value, static_cast<uint32_t>(c->console_buffer.size() + (c->console_dropped ? 1 : 0)));
+
+	if (c->console_dropped) {
+		zval entry;
+		array_init_size(&entry, 2);
+		add_assoc_string(&entry, "level", "warn");
+		add_assoc_str(&entry, "message", zend_strpprintf(0, "%zu console message(s) dropped, buffer size exceeded", c->console_dropped));
+		add_next_index_zval(return_value, &entry);
+		c->console_dropped = 0;
+	}
+
+	for (std::deque<v8js_console_entry>::iterator it = c->console_buffer.begin();
+		 it != c->console_buffer.end(); ++it) {
+		zval entry;
+		array_init_size(&entry, 2);
+		add_assoc_string(&entry, "level", const_cast<char *>(v8js_console_methods[it->type].name));
+		add_assoc_stringl(&entry, "message", const_cast<char *>(it->message.data()), it->message.size());
+		add_next_index_zval(return_value, &entry);
+	}
+
+	c->console_buffer.clear();
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
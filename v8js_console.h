@@ -0,0 +1,42 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_CONSOLE_H
+#define V8JS_CONSOLE_H
+
+/* Console levels, in order of severity */
+#define V8JS_CONSOLE_DEBUG		0
+#define V8JS_CONSOLE_INFO		1
+#define V8JS_CONSOLE_WARN		2
+#define V8JS_CONSOLE_ERROR		3
+#define V8JS_CONSOLE_NONE		4
+
+/* Parse level name (or number) as used by v8js.console_level */
+int v8js_console_parse_level(const char *str, size_t len);
+
+/* Register console object into passed global template */
+void v8js_register_console(v8::Local<v8::ObjectTemplate> global, v8::Isolate *isolate);
+
+/* Move buffered console lines to PHP array, clearing the buffer */
+void v8js_console_drain(v8js_ctx *c, zval *return_value);
+
+#endif /* V8JS_CONSOLE_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -20,8 +20,11 @@
 #include <limits>
 
 #include "php_v8js_macros.h"
+#include "v8js_dtrace.h"
 #include "v8js_exceptions.h"
+#include "v8js_metrics.h"
 #include "v8js_object_export.h"
+#include "v8js_tracing.h"
 #include "v8js_v8object_class.h"
 #include "v8js_v8.h"
 
@@ -57,6 +60,137 @@ static int v8js_is_assoc_array(HashTable *myht) /* {{{ */
 /* }}} */
 
 
+v8::MaybeLocal<v8::Value> v8js_hash_to_typed_array(HashTable *myht, int type, v8::Isolate *isolate) /* {{{ */
+{
+	uint32_t n = zend_hash_num_elements(myht);
+	bool all_int32 = true;
+	zval *data;
+
+	if (n > 0 && (!HT_IS_PACKED(myht) || !HT_IS_WITHOUT_HOLES(myht))) {
+		return v8::MaybeLocal<v8::Value>();
+	}
+
+	/* First pass only checks types, so nothing is allocated for mixed arrays */
+	ZEND_HASH_FOREACH_VAL(myht, data) {
+		if (Z_TYPE_P(data) == IS_LONG) {
+			if (Z_LVAL_P(data) < std::numeric_limits<int32_t>::min() || Z_LVAL_P(data) > std::numeric_limits<int32_t>::max()) {
+				all_int32 = false;
+			}
+		} else if (Z_TYPE_P(data) == IS_DOUBLE) {
+			all_int32 = false;
+		} else {
+			return v8::MaybeLocal<v8::Value>();
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	if (type == V8JS_TYPED_ARRAY_ANY) {
+		type = all_int32 ? V8JS_TYPED_ARRAY_INT32 : V8JS_TYPED_ARRAY_FLOAT64;
+	} else if (type == V8JS_TYPED_ARRAY_INT32 && !all_int32) {
+		return v8::MaybeLocal<v8::Value>();
+	}
+
+	if (type == V8JS_TYPED_ARRAY_INT32) {
+		v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, n * sizeof(int32_t));
+		int32_t *dst = static_cast<int32_t *>(buffer->GetBackingStore()->Data());
+
+		ZEND_HASH_FOREACH_VAL(myht, data) {
+			*dst++ = static_cast<int32_t>(Z_LVAL_P(data));
+		} ZEND_HASH_FOREACH_END();
+
+		return v8::Int32Array::New(buffer, 0, n);
+	}
+
+	v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, n * sizeof(double));
+	double *dst = static_cast<double *>(buffer->GetBackingStore()->Data());
+
+	ZEND_HASH_FOREACH_VAL(myht, data) {
+		*dst++ = Z_TYPE_P(data) == IS_LONG ? static_cast<double>(Z_LVAL_P(data)) : Z_DVAL_P(data);
+	} ZEND_HASH_FOREACH_END();
+
+	return v8::Float64Array::New(buffer, 0, n);
+}
+/* }}} */
+
+template<typename T>
+static void v8js_typed_array_fill_long(HashTable *ht, const void *src, size_t n) /* {{{ */
+{
+	const T *p = static_cast<const T *>(src);
+
+	ZEND_HASH_FILL_PACKED(ht) {
+		for (size_t i = 0; i < n; i ++) {
+			ZEND_HASH_FILL_SET_LONG(static_cast<zend_long>(p[i]));
+			ZEND_HASH_FILL_NEXT();
+		}
+	} ZEND_HASH_FILL_END();
+}
+/* }}} */
+
+template<typename T>
+static void v8js_typed_array_fill_double(HashTable *ht, const void *src, size_t n) /* {{{ */
+{
+	const T *p = static_cast<const T *>(src);
+
+	ZEND_HASH_FILL_PACKED(ht) {
+		for (size_t i = 0; i < n; i ++) {
+			ZEND_HASH_FILL_SET_DOUBLE(static_cast<double>(p[i]));
+			ZEND_HASH_FILL_NEXT();
+		}
+	} ZEND_HASH_FILL_END();
+}
+/* }}} */
+
+/* Convert TypedArray into packed PHP array, reading the backing store
+ * directly instead of calling Get() for every index.  Only element types
+ * known here are handled, false is returned for others (BigInt, Float16, ...)
+ * so they take the generic path. */
+static bool v8js_typed_array_to_zval(v8::Local<v8::TypedArray> array, zval *return_value) /* {{{ */
+{
+	size_t n = array->Length();
+	const void *src = NULL;
+	void (*fill)(HashTable *, const void *, size_t);
+
+	if (array->IsInt8Array()) {
+		fill = v8js_typed_array_fill_long<int8_t>;
+	} else if (array->IsUint8Array() || array->IsUint8ClampedArray()) {
+		fill = v8js_typed_array_fill_long<uint8_t>;
+	} else if (array->IsInt16Array()) {
+		fill = v8js_typed_array_fill_long<int16_t>;
+	} else if (array->IsUint16Array()) {
+		fill = v8js_typed_array_fill_long<uint16_t>;
+	} else if (array->IsInt32Array()) {
+		fill = v8js_typed_array_fill_long<int32_t>;
+	} else if (array->IsUint32Array()) {
+		fill = v8js_typed_array_fill_long<uint32_t>;
+	} else if (array->IsFloat32Array()) {
+		fill = v8js_typed_array_fill_double<float>;
+	} else if (array->IsFloat64Array()) {
+		fill = v8js_typed_array_fill_double<double>;
+	} else {
+		return false;
+	}
+
+	if (n > HT_MAX_SIZE) {
+		return false;
+	}
+
+	if (n > 0) {
+		std::shared_ptr<v8::BackingStore> store = array->Buffer()->GetBackingStore();
+		src = static_cast<const char *>(store->Data()) + array->ByteOffset();
+	}
+
+	array_init_size(return_value, static_cast<uint32_t>(n));
+
+	if (n == 0) {
+		return true;
+	}
+
+	zend_hash_real_init_packed(Z_ARRVAL_P(return_value));
+	fill(Z_ARRVAL_P(return_value), src, n);
+
+	return true;
+}
+/* }}} */
+
 static v8::Local<v8::Value> v8js_hash_to_jsarr(zval *value, v8::Isolate *isolate) /* {{{ */
 {
 	HashTable *myht = HASH_OF(value);
@@ -74,6 +208,16 @@ static v8::Local<v8::Value> v8js_hash_to_jsarr(zval *value, v8::Isolate *isolate
 		return V8JS_NULL;
 	}
 
+	v8js_ctx *ctx = (v8js_ctx *) isolate->GetData(0);
+
+	if (i > 0 && ctx && (ctx->flags & V8JS_FLAG_TYPED_ARRAYS)) {
+		v8::Local<v8::Value> typed_array;
+
+		if (v8js_hash_to_typed_array(myht, V8JS_TYPED_ARRAY_ANY, isolate).ToLocal(&typed_array)) {
+			return typed_array;
+		}
+	}
+
 	v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
 	newarr = v8::Array::New(isolate, i);
 
@@ -98,6 +242,82 @@ static v8::Local<v8::Value> v8js_hash_to_jsarr(zval *value, v8::Isolate *isolate
 }
 /* }}} */
 
+/* The caches are keyed by HashTable pointer, which must not outlive the
+ * opcache shared memory.  opcache_reset() is wrapped to bump a generation
+ * counter, contexts drop their cache once they notice it changed. */
+static zif_handler v8js_orig_opcache_reset = NULL;
+static zend_result (*v8js_orig_post_startup_cb)(void) = NULL;
+
+static ZEND_FUNCTION(v8js_opcache_reset) /* {{{ */
+{
+	v8js_orig_opcache_reset(INTERNAL_FUNCTION_PARAM_PASSTHRU);
+	V8JSG(immutable_array_generation)++;
+}
+/* }}} */
+
+static zend_result v8js_immutable_array_post_startup(void) /* {{{ */
+{
+	if (v8js_orig_post_startup_cb && v8js_orig_post_startup_cb() != SUCCESS) {
+		return FAILURE;
+	}
+
+	/* opcache registers its functions after our MINIT, hence hook them now */
+	zend_function *func = (zend_function *) zend_hash_str_find_ptr(CG(function_table), ZEND_STRL("opcache_reset"));
+
+	if (func && func->type == ZEND_INTERNAL_FUNCTION) {
+		v8js_orig_opcache_reset = func->internal_function.handler;
+		func->internal_function.handler = ZEND_FN(v8js_opcache_reset);
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
+void v8js_immutable_array_cache_init() /* {{{ */
+{
+	v8js_orig_post_startup_cb = zend_post_startup_cb;
+	zend_post_startup_cb = v8js_immutable_array_post_startup;
+}
+/* }}} */
+
+/* Immutable arrays (opcache-interned literals, constant tables) can't change,
+ * hence they are converted once per context and handed out frozen from then
+ * on.  Nested immutable arrays take the same path, so the result is frozen
+ * deeply. */
+static v8::Local<v8::Value> v8js_immutable_array_to_js(zval *value, v8::Isolate *isolate) /* {{{ */
+{
+	v8js_ctx *ctx = (v8js_ctx *) isolate->GetData(0);
+	HashTable *myht = Z_ARRVAL_P(value);
+
+	if (ctx->immutable_arrays_generation != V8JSG(immutable_array_generation)) {
+		for (std::unordered_map<HashTable *, v8js_persistent_value_t>::iterator it = ctx->immutable_arrays.begin();
+			 it != ctx->immutable_arrays.end(); ++it) {
+			it->second.Reset();
+		}
+		ctx->immutable_arrays.clear();
+		ctx->immutable_arrays_generation = V8JSG(immutable_array_generation);
+	}
+
+	std::unordered_map<HashTable *, v8js_persistent_value_t>::iterator it = ctx->immutable_arrays.find(myht);
+
+	if (it != ctx->immutable_arrays.end()) {
+		return v8::Local<v8::Value>::New(isolate, it->second);
+	}
+
+	v8::Local<v8::Value> jsValue = v8js_hash_to_jsarr(value, isolate);
+
+	if (!jsValue->IsObject()) {
+		return jsValue;
+	}
+
+	v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
+	jsValue.As<v8::Object>()->SetIntegrityLevel(v8_context, v8::IntegrityLevel::kFrozen);
+	ctx->immutable_arrays[myht].Reset(isolate, jsValue);
+
+	return jsValue;
+}
+/* }}} */
+
 v8::Local<v8::Value> zend_long_to_v8js(zend_long v, v8::Isolate *isolate) /* {{{ */
 {
 	if (v < std::numeric_limits<int32_t>::min() || v > std::numeric_limits<int32_t>::max()) {
@@ -114,6 +334,10 @@ v8::Local<v8::Value> zval_to_v8js(zval *value, v8::Isolate *isolate) /* {{{ */
 	zend_string *value_str;
 	zend_class_entry *ce;
 
+	V8JS_PROBE1(convert__to__js, Z_TYPE_P(value));
+	/* Scalars are too cheap (and too many) to be traced */
+	v8js_trace_scope trace_scope(Z_TYPE_P(value) == IS_ARRAY || Z_TYPE_P(value) == IS_OBJECT ? "zval_to_v8js" : NULL);
+
 	switch (Z_TYPE_P(value))
 	{
 		case IS_INDIRECT:
@@ -125,7 +349,14 @@ v8::Local<v8::Value> zval_to_v8js(zval *value, v8::Isolate *isolate) /* {{{ */
 			break;
 
 		case IS_ARRAY:
-			jsValue = v8js_hash_to_jsarr(value, isolate);
+			/* Empty arrays are immutable too, but often extended by scripts.
+			 * TypedArrays can't be frozen, so the cache is bypassed for them. */
+			if ((GC_FLAGS(Z_ARRVAL_P(value)) & GC_IMMUTABLE) && zend_hash_num_elements(Z_ARRVAL_P(value)) > 0 &&
+				V8JSG(immutable_array_cache) && !(((v8js_ctx *) isolate->GetData(0))->flags & V8JS_FLAG_TYPED_ARRAYS)) {
+				jsValue = v8js_immutable_array_to_js(value, isolate);
+			} else {
+				jsValue = v8js_hash_to_jsarr(value, isolate);
+			}
 			break;
 
 		case IS_OBJECT:
@@ -151,6 +382,7 @@ v8::Local<v8::Value> zval_to_v8js(zval *value, v8::Isolate *isolate) /* {{{ */
 			}
 
 			jsValue = V8JS_ZSTR(value_str);
+			V8JS_METRIC_LOCAL_ADD(conversion_bytes, ZSTR_LEN(value_str));
 			break;
 
 		case IS_LONG:
@@ -189,11 +421,55 @@ int v8js_to_zval(v8::Local<v8::Value> jsValue, zval *return_value, int flags, v8
 	v8js_ctx *ctx = (v8js_ctx *) isolate->GetData(0);
 	v8::Local<v8::Context> v8_context = v8::Local<v8::Context>::New(isolate, ctx->context);
 
-	if (jsValue->IsString())
+	V8JS_PROBE1(convert__to__php, flags);
+	v8js_trace_scope trace_scope(jsValue->IsObject() ? "v8js_to_zval" : NULL);
+
+	if (jsValue->IsString() && jsValue.As<v8::String>()->IsOneByte())
+	{
+		/* Latin-1 backed string, read it as is and only widen the
+		 * (typically few, if any) non-ASCII chars to UTF-8 */
+		v8::Local<v8::String> str = jsValue.As<v8::String>();
+		int len = str->Length();
+		zend_string *latin1 = zend_string_alloc(len, 0);
+		str->WriteOneByte(isolate, reinterpret_cast<uint8_t *>(ZSTR_VAL(latin1)), 0, len, v8::String::NO_NULL_TERMINATION);
+		ZSTR_VAL(latin1)[len] = '\0';
+
+		if (v8js_is_ascii(reinterpret_cast<const unsigned char *>(ZSTR_VAL(latin1)), len)) {
+			RETVAL_NEW_STR(latin1);
+		}
+		else {
+			const unsigned char *src = reinterpret_cast<const unsigned char *>(ZSTR_VAL(latin1));
+			size_t extra = 0;
+
+			for (int i = 0; i < len; i ++) {
+				extra += src[i] >> 7;
+			}
+
+			zend_string *utf8 = zend_string_alloc(len + extra, 0);
+			unsigned char *dst = reinterpret_cast<unsigned char *>(ZSTR_VAL(utf8));
+
+			for (int i = 0; i < len; i ++) {
+				if (src[i] < 0x80) {
+					*dst++ = src[i];
+				} else {
+					*dst++ = 0xc0 | (src[i] >> 6);
+					*dst++ = 0x80 | (src[i] & 0x3f);
+				}
+			}
+
+			*dst = '\0';
+			zend_string_efree(latin1);
+			RETVAL_NEW_STR(utf8);
+		}
+
+		V8JS_METRIC_LOCAL_ADD(conversion_bytes, Z_STRLEN_P(return_value));
+	}
+	else if (jsValue->IsString())
 	{
 		v8::String::Utf8Value str(isolate, jsValue);
 		const char *cstr = ToCString(str);
 		RETVAL_STRINGL(cstr, str.length());
+		V8JS_METRIC_LOCAL_ADD(conversion_bytes, str.length());
 	}
 	else if (jsValue->IsBoolean())
 	{
@@ -268,6 +544,12 @@ int v8js_to_zval(v8::Local<v8::Value> jsValue, zval *return_value, int flags, v8
 			return SUCCESS;
 		}
 
+		/* Not with plain FORCE_ARRAY, which narrows integral floats to int */
+		if ((flags & V8JS_FLAG_TYPED_ARRAYS) && jsValue->IsTypedArray() &&
+			v8js_typed_array_to_zval(jsValue.As<v8::TypedArray>(), return_value)) {
+			return SUCCESS;
+		}
+
 		if ((flags & V8JS_FLAG_FORCE_ARRAY && !jsValue->IsFunction()) || jsValue->IsArray()) {
 			array_init(return_value);
 			return v8js_get_properties_hash(jsValue, Z_ARRVAL_P(return_value), flags, isolate);
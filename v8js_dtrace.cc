@@ -0,0 +1,60 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_dtrace.h"
+
+#ifdef HAVE_V8JS_DTRACE
+
+/* Probe semaphores, written by the tracer (hence the dedicated section) */
+#define V8JS_PROBE_DEFINE(name) \
+	unsigned short V8JS_PROBE_SEMAPHORE(name) __attribute__((unused)) __attribute__((section(".probes")));
+V8JS_PROBES(V8JS_PROBE_DEFINE)
+
+static thread_local uint64_t v8js_dtrace_gc_start;
+
+static void v8js_dtrace_gc_prologue(v8::Isolate *isolate, v8::GCType type, v8::GCCallbackFlags flags) /* {{{ */
+{
+	v8js_dtrace_gc_start = V8JS_PROBE_TIMESTAMP(gc__done);
+	V8JS_PROBE2(gc__start, static_cast<int>(type), static_cast<int>(flags));
+}
+/* }}} */
+
+static void v8js_dtrace_gc_epilogue(v8::Isolate *isolate, v8::GCType type, v8::GCCallbackFlags flags) /* {{{ */
+{
+	V8JS_PROBE3(gc__done, static_cast<int>(type), static_cast<int>(flags),
+		v8js_dtrace_gc_start ? v8js_probe_now() - v8js_dtrace_gc_start : 0);
+}
+/* }}} */
+
+void v8js_dtrace_register_gc(v8::Isolate *isolate) /* {{{ */
+{
+	isolate->AddGCPrologueCallback(v8js_dtrace_gc_prologue);
+	isolate->AddGCEpilogueCallback(v8js_dtrace_gc_epilogue);
+}
+/* }}} */
+
+#endif /* HAVE_V8JS_DTRACE */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,102 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_DTRACE_H
+#define V8JS_DTRACE_H
+
+/* USDT probes (provider "v8js"), compiled in with --enable-v8js-dtrace.
+ *
+ * Every probe has a semaphore, which is incremented by the tracer when it
+ * attaches.  Probe arguments (and timestamps) are only computed while the
+ * semaphore is set, hence the probes cost a single (predicted) branch when
+ * nobody is listening. */
+#define V8JS_PROBES(X) \
+	X(execute__entry)		/* (const char *identifier, int depth) */ \
+	X(execute__return)		/* (const char *identifier, int depth, uint64 duration_ns, int status) */ \
+	X(compile__entry)		/* (const char *identifier, size_t source_length) */ \
+	X(compile__return)		/* (const char *identifier, uint64 duration_ns, int success) */ \
+	X(require)				/* (const char *module_id, int cached) */ \
+	X(callback__entry)		/* (const char *class_name, const char *method_name) */ \
+	X(callback__return)		/* (const char *class_name, const char *method_name, uint64 duration_ns) */ \
+	X(convert__to__js)		/* (int zval_type) */ \
+	X(convert__to__php)		/* (int flags) */ \
+	X(watchdog__terminate)	/* (void *v8js, int reason, uint64 limit) */ \
+	X(gc__start)			/* (int gc_type, int gc_flags) */ \
+	X(gc__done)				/* (int gc_type, int gc_flags, uint64 duration_ns) */
+
+/* execute__return status codes */
+#define V8JS_PROBE_STATUS_OK			0
+#define V8JS_PROBE_STATUS_EXCEPTION		1
+#define V8JS_PROBE_STATUS_TIME_LIMIT	2
+#define V8JS_PROBE_STATUS_MEMORY_LIMIT	3
+
+/* watchdog__terminate reasons */
+#define V8JS_PROBE_REASON_TIME_LIMIT	1
+#define V8JS_PROBE_REASON_MEMORY_LIMIT	2
+
+#ifdef HAVE_V8JS_DTRACE
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define V8JS_PROBE_SEMAPHORE(name)	v8js_##name##_semaphore
+#define V8JS_PROBE_DECLARE(name)	extern "C" unsigned short V8JS_PROBE_SEMAPHORE(name);
+V8JS_PROBES(V8JS_PROBE_DECLARE)
+
+#define V8JS_PROBE_ENABLED(name)	UNEXPECTED(V8JS_PROBE_SEMAPHORE(name))
+
+#define V8JS_PROBE1(name, a) \
+	do { if (V8JS_PROBE_ENABLED(name)) { DTRACE_PROBE1(v8js, name, a); } } while (0)
+#define V8JS_PROBE2(name, a, b) \
+	do { if (V8JS_PROBE_ENABLED(name)) { DTRACE_PROBE2(v8js, name, a, b); } } while (0)
+#define V8JS_PROBE3(name, a, b, c) \
+	do { if (V8JS_PROBE_ENABLED(name)) { DTRACE_PROBE3(v8js, name, a, b, c); } } while (0)
+#define V8JS_PROBE4(name, a, b, c, d) \
+	do { if (V8JS_PROBE_ENABLED(name)) { DTRACE_PROBE4(v8js, name, a, b, c, d); } } while (0)
+
+/* Monotonic timestamp in nanoseconds, for probe durations */
+static inline uint64_t v8js_probe_now() /* {{{ */
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+/* }}} */
+
+#define V8JS_PROBE_TIMESTAMP(name)	(V8JS_PROBE_ENABLED(name) ? v8js_probe_now() : 0)
+
+/* Register GC prologue/epilogue callbacks firing the gc__* probes */
+void v8js_dtrace_register_gc(v8::Isolate *isolate);
+
+#else
+
+/* Arguments are never evaluated, just referenced to keep compilers quiet */
+#define V8JS_PROBE_ENABLED(name)			0
+#define V8JS_PROBE1(name, a)				do { if (0) { (void) (a); } } while (0)
+#define V8JS_PROBE2(name, a, b)				do { if (0) { (void) (a); (void) (b); } } while (0)
+#define V8JS_PROBE3(name, a, b, c)			do { if (0) { (void) (a); (void) (b); (void) (c); } } while (0)
+#define V8JS_PROBE4(name, a, b, c, d)		do { if (0) { (void) (a); (void) (b); (void) (c); (void) (d); } } while (0)
+#define V8JS_PROBE_TIMESTAMP(name)			0
+#define v8js_probe_now()					0
+
+#endif /* HAVE_V8JS_DTRACE */
+
+#endif /* V8JS_DTRACE_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,546 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_encoding.h"
+
+#define V8JS_DECODER_FATAL		(1<<0)
+#define V8JS_DECODER_IGNORE_BOM	(1<<1)
+
+/* TextDecoder options are stored as an aligned pointer into this table,
+ * so decode() doesn't have to look up JS properties on every call. */
+static const int v8js_text_decoder_modes[4] = { 0, 1, 2, 3 };
+
+static const unsigned char v8js_base64_table[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Reverse lookup, 0x80 marks characters outside of the alphabet */
+static const unsigned char v8js_base64_reverse[256] = {
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,   62, 0x80, 0x80, 0x80,   63,
+	  52,   53,   54,   55,   56,   57,   58,   59,   60,   61, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+	  15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+	  41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+};
+
+bool v8js_utf8_validate(const unsigned char *s, size_t len) /* {{{ */
+{
+	size_t i = 0;
+
+	while (i < len) {
+		/* Skip ASCII runs in blocks, multi-byte sequences are rare in most
+		 * payloads we get to see. */
+		if (len - i >= 16 && v8js_is_ascii(s + i, 16)) {
+			i += 16;
+			continue;
+		}
+
+		unsigned char c = s[i];
+
+		if (c < 0x80) {
+			i ++;
+		}
+		else if (c >= 0xc2 && c <= 0xdf) {
+			if (len - i < 2 || (s[i + 1] & 0xc0) != 0x80) {
+				return false;
+			}
+			i += 2;
+		}
+		else if (c >= 0xe0 && c <= 0xef) {
+			if (len - i < 3 || (s[i + 1] & 0xc0) != 0x80 || (s[i + 2] & 0xc0) != 0x80) {
+				return false;
+			}
+			if ((c == 0xe0 && s[i + 1] < 0xa0) /* overlong */
+				|| (c == 0xed && s[i + 1] > 0x9f)) /* surrogate */ {
+				return false;
+			}
+			i += 3;
+		}
+		else if (c >= 0xf0 && c <= 0xf4) {
+			if (len - i < 4 || (s[i + 1] & 0xc0) != 0x80 || (s[i + 2] & 0xc0) != 0x80 || (s[i + 3] & 0xc0) != 0x80) {
+				return false;
+			}
+			if ((c == 0xf0 && s[i + 1] < 0x90) /* overlong */
+				|| (c == 0xf4 && s[i + 1] > 0x8f)) /* > U+10FFFF */ {
+				return false;
+			}
+			i += 4;
+		}
+		else {
+			return false;
+		}
+	}
+
+	return true;
+}
+/* }}} */
+
+size_t v8js_base64_encode(const unsigned char *src, size_t len, unsigned char *dst) /* {{{ */
+{
+	unsigned char *p = dst;
+	size_t i = 0;
+
+	for (; i + 3 <= len; i += 3) {
+		uint32_t triple = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+		*p++ = v8js_base64_table[(triple >> 18) & 0x3f];
+		*p++ = v8js_base64_table[(triple >> 12) & 0x3f];
+		*p++ = v8js_base64_table[(triple >> 6) & 0x3f];
+		*p++ = v8js_base64_table[triple & 0x3f];
+	}
+
+	if (len - i == 1) {
+		*p++ = v8js_base64_table[src[i] >> 2];
+		*p++ = v8js_base64_table[(src[i] & 0x03) << 4];
+		*p++ = '=';
+		*p++ = '=';
+	}
+	else if (len - i == 2) {
+		*p++ = v8js_base64_table[src[i] >> 2];
+		*p++ = v8js_base64_table[((src[i] & 0x03) << 4) | (src[i + 1] >> 4)];
+		*p++ = v8js_base64_table[(src[i + 1] & 0x0f) << 2];
+		*p++ = '=';
+	}
+
+	return p - dst;
+}
+/* }}} */
+
+bool v8js_base64_decode(const unsigned char *src, size_t len, unsigned char *dst, size_t *dst_len) /* {{{ */
+{
+	unsigned char *p = dst;
+	uint32_t acc = 0;
+	size_t chars = 0, pad = 0;
+
+	for (size_t i = 0; i < len; i ++) {
+		unsigned char c = src[i];
+
+		/* ASCII whitespace is removed up front by forgiving-base64 */
+		if (c == ' ' || c == '\t' || c == '\n' || c == '\f' || c == '\r') {
+			continue;
+		}
+
+		if (c == '=') {
+			pad ++;
+			continue;
+		}
+
+		unsigned char v = v8js_base64_reverse[c];
+
+		if (pad || (v & 0x80)) {
+			/* data after padding or character outside of the alphabet */
+			return false;
+		}
+
+		acc = (acc << 6) | v;
+
+		if ((++ chars & 3) == 0) {
+			*p++ = (acc >> 16) & 0xff;
+			*p++ = (acc >> 8) & 0xff;
+			*p++ = acc & 0xff;
+			acc = 0;
+		}
+	}
+
+	if (pad && (pad > 2 || ((chars + pad) & 3) != 0)) {
+		return false;
+	}
+
+	switch (chars & 3) {
+		case 1:
+			return false;
+
+		case 2:
+			*p++ = (acc >> 4) & 0xff;
+			break;
+
+		case 3:
+			*p++ = (acc >> 10) & 0xff;
+			*p++ = (acc >> 2) & 0xff;
+			break;
+	}
+
+	*dst_len = p - dst;
+	return true;
+}
+/* }}} */
+
+/* Fetch pointer & length of the bytes backing an ArrayBuffer(View), without copying them */
+static bool v8js_encoding_get_bytes(v8::Local<v8::Value> value, const unsigned char **data, size_t *len) /* {{{ */
+{
+	if (value->IsArrayBufferView()) {
+		v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+		std::shared_ptr<v8::BackingStore> store = view->Buffer()->GetBackingStore();
+		*data = static_cast<const unsigned char *>(store->Data()) + view->ByteOffset();
+		*len = view->ByteLength();
+		return true;
+	}
+
+	if (value->IsArrayBuffer()) {
+		std::shared_ptr<v8::BackingStore> store = value.As<v8::ArrayBuffer>()->GetBackingStore();
+		*data = static_cast<const unsigned char *>(store->Data());
+		*len = store->ByteLength();
+		return true;
+	}
+
+	if (value->IsSharedArrayBuffer()) {
+		std::shared_ptr<v8::BackingStore> store = value.As<v8::SharedArrayBuffer>()->GetBackingStore();
+		*data = static_cast<const unsigned char *>(store->Data());
+		*len = store->ByteLength();
+		return true;
+	}
+
+	return false;
+}
+/* }}} */
+
+static void v8js_encoding_throw(v8::Isolate *isolate, const char *message, bool range_error = false) /* {{{ */
+{
+	v8::Local<v8::String> str = V8JS_STR(message);
+	isolate->ThrowException(range_error ? v8::Exception::RangeError(str) : v8::Exception::TypeError(str));
+}
+/* }}} */
+
+/* new TextEncoder() */
+static void v8js_text_encoder_construct(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+
+	if (!info.IsConstructCall()) {
+		v8js_encoding_throw(isolate, "Constructor TextEncoder requires 'new'");
+		return;
+	}
+}
+/* }}} */
+
+/* TextEncoder.prototype.encode(string) -> Uint8Array */
+static void v8js_text_encoder_encode(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	v8::Local<v8::String> str;
+
+	if (info.Length() < 1 || info[0]->IsUndefined()) {
+		str = v8::String::Empty(isolate);
+	}
+	else if (!info[0]->ToString(v8_context).ToLocal(&str)) {
+		return;
+	}
+
+	size_t len = str->Utf8Length(isolate);
+	v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, len);
+
+	if (len) {
+		/* Write right into the backing store, no intermediate buffer */
+		char *data = static_cast<char *>(buffer->GetBackingStore()->Data());
+		str->WriteUtf8(isolate, data, static_cast<int>(len), NULL,
+			v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+	}
+
+	info.GetReturnValue().Set(v8::Uint8Array::New(buffer, 0, len));
+}
+/* }}} */
+
+/* TextEncoder.prototype.encodeInto(string, Uint8Array) -> { read, written } */
+static void v8js_text_encoder_encode_into(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	v8::Local<v8::String> str;
+
+	if (info.Length() < 2 || !info[1]->IsUint8Array()) {
+		v8js_encoding_throw(isolate, "TextEncoder.encodeInto expects a string and an Uint8Array");
+		return;
+	}
+
+	if (!info[0]->ToString(v8_context).ToLocal(&str)) {
+		return;
+	}
+
+	const unsigned char *data;
+	size_t capacity;
+	v8js_encoding_get_bytes(info[1], &data, &capacity);
+
+	if (capacity > static_cast<size_t>(std::numeric_limits<int>::max())) {
+		capacity = std::numeric_limits<int>::max();
+	}
+
+	int read = 0, written = 0;
+
+	if (capacity) {
+		written = str->WriteUtf8(isolate, reinterpret_cast<char *>(const_cast<unsigned char *>(data)),
+			static_cast<int>(capacity), &read,
+			v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+	}
+
+	v8::Local<v8::Object> result = v8::Object::New(isolate);
+	result->CreateDataProperty(v8_context, V8JS_SYM("read"), V8JS_INT(read));
+	result->CreateDataProperty(v8_context, V8JS_SYM("written"), V8JS_INT(written));
+	info.GetReturnValue().Set(result);
+}
+/* }}} */
+
+/* new TextDecoder([label [, options]]) */
+static void v8js_text_decoder_construct(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	int mode = 0;
+
+	if (!info.IsConstructCall()) {
+		v8js_encoding_throw(isolate, "Constructor TextDecoder requires 'new'");
+		return;
+	}
+
+	if (info.Length() >= 1 && !info[0]->IsUndefined()) {
+		v8::Local<v8::String> label;
+
+		if (!info[0]->ToString(v8_context).ToLocal(&label)) {
+			return;
+		}
+
+		v8::String::Utf8Value label_str(isolate, label);
+		const char *cstr = ToCString(label_str);
+
+		/* Only UTF-8 is supported natively */
+		if (strcasecmp(cstr, "utf-8") != 0 && strcasecmp(cstr, "utf8") != 0
+			&& strcasecmp(cstr, "unicode-1-1-utf-8") != 0) {
+			v8js_encoding_throw(isolate, "TextDecoder only supports the utf-8 encoding", true);
+			return;
+		}
+	}
+
+	if (info.Length() >= 2 && info[1]->IsObject()) {
+		v8::Local<v8::Object> options = info[1].As<v8::Object>();
+		v8::Local<v8::Value> value;
+
+		if (options->Get(v8_context, V8JS_SYM("fatal")).ToLocal(&value) && value->BooleanValue(isolate)) {
+			mode |= V8JS_DECODER_FATAL;
+		}
+
+		if (options->Get(v8_context, V8JS_SYM("ignoreBOM")).ToLocal(&value) && value->BooleanValue(isolate)) {
+			mode |= V8JS_DECODER_IGNORE_BOM;
+		}
+	}
+
+	v8::Local<v8::Object> self = info.This();
+	self->SetAlignedPointerInInternalField(0, const_cast<int *>(&v8js_text_decoder_modes[mode]));
+	self->DefineOwnProperty(v8_context, V8JS_SYM("fatal"), V8JS_BOOL(mode & V8JS_DECODER_FATAL), v8::ReadOnly);
+	self->DefineOwnProperty(v8_context, V8JS_SYM("ignoreBOM"), V8JS_BOOL(mode & V8JS_DECODER_IGNORE_BOM), v8::ReadOnly);
+}
+/* }}} */
+
+/* TextDecoder.prototype.decode([buffer]) -> string */
+static void v8js_text_decoder_decode(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	int mode = *static_cast<int *>(info.Holder()->GetAlignedPointerFromInternalField(0));
+
+	if (info.Length() < 1 || info[0]->IsUndefined()) {
+		info.GetReturnValue().Set(v8::String::Empty(isolate));
+		return;
+	}
+
+	if (info.Length() >= 2 && info[1]->IsObject()) {
+		v8::Local<v8::Value> stream;
+
+		if (info[1].As<v8::Object>()->Get(v8_context, V8JS_SYM("stream")).ToLocal(&stream) && stream->BooleanValue(isolate)) {
+			v8js_encoding_throw(isolate, "TextDecoder streaming mode is not supported");
+			return;
+		}
+	}
+
+	const unsigned char *data;
+	size_t len;
+
+	if (!v8js_encoding_get_bytes(info[0], &data, &len)) {
+		v8js_encoding_throw(isolate, "TextDecoder.decode expects an ArrayBuffer or ArrayBufferView");
+		return;
+	}
+
+	if (!(mode & V8JS_DECODER_IGNORE_BOM) && len >= 3
+		&& data[0] == 0xef && data[1] == 0xbb && data[2] == 0xbf) {
+		data += 3;
+		len -= 3;
+	}
+
+	if (len > static_cast<size_t>(std::numeric_limits<int>::max())) {
+		v8js_encoding_throw(isolate, "Input exceeds maximum string length", true);
+		return;
+	}
+
+	v8::MaybeLocal<v8::String> result;
+
+	if (v8js_is_ascii(data, len)) {
+		/* Pure ASCII, spare V8 from decoding UTF-8 */
+		result = v8::String::NewFromOneByte(isolate, data, v8::NewStringType::kNormal, static_cast<int>(len));
+	}
+	else if ((mode & V8JS_DECODER_FATAL) && !v8js_utf8_validate(data, len)) {
+		v8js_encoding_throw(isolate, "The encoded data was not valid utf-8");
+		return;
+	}
+	else {
+		/* V8 substitutes malformed sequences with U+FFFD itself */
+		result = v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(data), v8::NewStringType::kNormal, static_cast<int>(len));
+	}
+
+	v8::Local<v8::String> str;
+	if (result.ToLocal(&str)) {
+		info.GetReturnValue().Set(str);
+	}
+}
+/* }}} */
+
+/* global.btoa - base64 encode a binary (latin1) string */
+static void v8js_btoa(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	v8::Local<v8::String> str;
+
+	if (info.Length() < 1) {
+		v8js_encoding_throw(isolate, "btoa expects exactly one argument");
+		return;
+	}
+
+	if (!info[0]->ToString(v8_context).ToLocal(&str)) {
+		return;
+	}
+
+	if (!str->ContainsOnlyOneByte()) {
+		isolate->ThrowException(v8::Exception::Error(V8JS_SYM("InvalidCharacterError: string contains characters outside of the Latin1 range")));
+		return;
+	}
+
+	size_t len = str->Length();
+	size_t out_len = 4 * ((len + 2) / 3);
+
+	if (out_len > static_cast<size_t>(std::numeric_limits<int>::max())) {
+		v8js_encoding_throw(isolate, "Input exceeds maximum string length", true);
+		return;
+	}
+
+	unsigned char *in = static_cast<unsigned char *>(emalloc(len + 1));
+	unsigned char *out = static_cast<unsigned char *>(emalloc(out_len + 1));
+
+	str->WriteOneByte(isolate, in, 0, static_cast<int>(len), v8::String::NO_NULL_TERMINATION);
+	v8js_base64_encode(in, len, out);
+
+	v8::Local<v8::String> result;
+	if (v8::String::NewFromOneByte(isolate, out, v8::NewStringType::kNormal, static_cast<int>(out_len)).ToLocal(&result)) {
+		info.GetReturnValue().Set(result);
+	}
+
+	efree(in);
+	efree(out);
+}
+/* }}} */
+
+/* global.atob - decode base64 into a binary (latin1) string */
+static void v8js_atob(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	v8::Local<v8::String> str;
+
+	if (info.Length() < 1) {
+		v8js_encoding_throw(isolate, "atob expects exactly one argument");
+		return;
+	}
+
+	if (!info[0]->ToString(v8_context).ToLocal(&str)) {
+		return;
+	}
+
+	size_t len = str->Length();
+	size_t out_len = 0;
+	bool valid = str->ContainsOnlyOneByte();
+	unsigned char *in = NULL, *out = NULL;
+
+	if (valid) {
+		in = static_cast<unsigned char *>(emalloc(len + 1));
+		out = static_cast<unsigned char *>(emalloc(3 * (len / 4) + 3));
+
+		str->WriteOneByte(isolate, in, 0, static_cast<int>(len), v8::String::NO_NULL_TERMINATION);
+		valid = v8js_base64_decode(in, len, out, &out_len);
+	}
+
+	if (!valid) {
+		isolate->ThrowException(v8::Exception::Error(V8JS_SYM("InvalidCharacterError: string to be decoded is not correctly encoded")));
+	}
+	else {
+		v8::Local<v8::String> result;
+		if (v8::String::NewFromOneByte(isolate, out, v8::NewStringType::kNormal, static_cast<int>(out_len)).ToLocal(&result)) {
+			info.GetReturnValue().Set(result);
+		}
+	}
+
+	if (in) {
+		efree(in);
+		efree(out);
+	}
+}
+/* }}} */
+
+void v8js_register_encoding(v8::Local<v8::ObjectTemplate> global, v8::Isolate *isolate) /* {{{ */
+{
+	/* TextEncoder */
+	v8::Local<v8::FunctionTemplate> encoder_tpl = v8::FunctionTemplate::New(isolate, v8js_text_encoder_construct);
+	v8::Local<v8::Signature> encoder_sig = v8::Signature::New(isolate, encoder_tpl);
+	encoder_tpl->SetClassName(V8JS_SYM("TextEncoder"));
+	encoder_tpl->InstanceTemplate()->Set(V8JS_SYM("encoding"), V8JS_SYM("utf-8"), v8::ReadOnly);
+	encoder_tpl->PrototypeTemplate()->Set(V8JS_SYM("encode"),
+		v8::FunctionTemplate::New(isolate, v8js_text_encoder_encode, v8::Local<v8::Value>(), encoder_sig));
+	encoder_tpl->PrototypeTemplate()->Set(V8JS_SYM("encodeInto"),
+		v8::FunctionTemplate::New(isolate, v8js_text_encoder_encode_into, v8::Local<v8::Value>(), encoder_sig));
+
+	/* TextDecoder */
+	v8::Local<v8::FunctionTemplate> decoder_tpl = v8::FunctionTemplate::New(isolate, v8js_text_decoder_construct);
+	v8::Local<v8::Signature> decoder_sig = v8::Signature::New(isolate, decoder_tpl);
+	decoder_tpl->SetClassName(V8JS_SYM("TextDecoder"));
+	decoder_tpl->InstanceTemplate()->SetInternalFieldCount(1);
+	decoder_tpl->InstanceTemplate()->Set(V8JS_SYM("encoding"), V8JS_SYM("utf-8"), v8::ReadOnly);
+	decoder_tpl->PrototypeTemplate()->Set(V8JS_SYM("decode"),
+		v8::FunctionTemplate::New(isolate, v8js_text_decoder_decode, v8::Local<v8::Value>(), decoder_sig));
+
+	/* Not read-only, so existing polyfills can still replace them */
+	global->Set(V8JS_SYM("TextEncoder"), encoder_tpl, v8::DontEnum);
+	global->Set(V8JS_SYM("TextDecoder"), decoder_tpl, v8::DontEnum);
+	global->Set(V8JS_SYM("btoa"), v8::FunctionTemplate::New(isolate, v8js_btoa), v8::DontEnum);
+	global->Set(V8JS_SYM("atob"), v8::FunctionTemplate::New(isolate, v8js_atob), v8::DontEnum);
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
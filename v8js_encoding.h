@@ -0,0 +1,78 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_ENCODING_H
+#define V8JS_ENCODING_H
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define V8JS_HAVE_SSE2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define V8JS_HAVE_NEON 1
+#endif
+
+/* Check whether the passed buffer consists of 7-bit ASCII characters only,
+ * testing 16 bytes per step where SSE2 or NEON is available. */
+static inline bool v8js_is_ascii(const unsigned char *s, size_t len) /* {{{ */
+{
+	size_t i = 0;
+
+#if defined(V8JS_HAVE_SSE2)
+	for (; i + 16 <= len; i += 16) {
+		__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+		if (_mm_movemask_epi8(chunk)) {
+			return false;
+		}
+	}
+#elif defined(V8JS_HAVE_NEON)
+	for (; i + 16 <= len; i += 16) {
+		if (vmaxvq_u8(vld1q_u8(s + i)) & 0x80) {
+			return false;
+		}
+	}
+#endif
+
+	for (; i < len; i ++) {
+		if (s[i] & 0x80) {
+			return false;
+		}
+	}
+
+	return true;
+}
+/* }}} */
+
+/* Validate UTF-8 input (rejecting overlong forms and surrogates) */
+bool v8js_utf8_validate(const unsigned char *s, size_t len);
+
+/* Base64 helpers, encoded length is 4 * ceil(len / 3) */
+size_t v8js_base64_encode(const unsigned char *src, size_t len, unsigned char *dst);
+
+/* Forgiving-base64 decode (as used by atob), returns false on malformed
+ * input.  dst must hold at least 3 * (len / 4) + 2 bytes. */
+bool v8js_base64_decode(const unsigned char *src, size_t len, unsigned char *dst, size_t *dst_len);
+
+/* Register TextEncoder, TextDecoder, atob and btoa on the global template */
+void v8js_register_encoding(v8::Local<v8::ObjectTemplate> global, v8::Isolate *isolate);
+
+#endif /* V8JS_ENCODING_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,291 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2016 The PHP Group                                     |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_iterator_export.h"
+
+extern "C" {
+#include "zend_exceptions.h"
+#include "zend_interfaces.h"
+}
+
+static void v8js_php_iterator_release(v8js_php_iterator *iter) /* {{{ */
+{
+	if (iter->it) {
+		zend_iterator_dtor(iter->it);
+		iter->it = NULL;
+	}
+}
+/* }}} */
+
+static void v8js_php_iterator_free(v8js_php_iterator *iter) /* {{{ */
+{
+	v8js_php_iterator_release(iter);
+	iter->handle.Reset();
+	iter->ctx->php_iterators.erase(iter->pos);
+	delete iter;
+}
+/* }}} */
+
+static void v8js_php_iterator_weak_callback(const v8::WeakCallbackInfo<v8js_php_iterator> &data) /* {{{ */
+{
+	v8js_php_iterator_free(data.GetParameter());
+}
+/* }}} */
+
+/* Pass pending PHP exception on to JS (or stop execution), like callbacks do */
+static void v8js_php_iterator_exception(v8::Isolate *isolate, v8js_ctx *ctx) /* {{{ */
+{
+	if (ctx->flags & V8JS_FLAG_PROPAGATE_PHP_EXCEPTIONS) {
+		zval tmp_zv;
+		ZVAL_OBJ(&tmp_zv, EG(exception));
+		isolate->ThrowException(zval_to_v8js(&tmp_zv, isolate));
+		zend_clear_exception();
+	} else {
+		v8js_terminate_execution(isolate);
+	}
+}
+/* }}} */
+
+/* next and return carry a signature, so V8 only calls them on our iterators */
+static v8js_php_iterator *v8js_php_iterator_fetch(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Local<v8::Object> self = info.Holder();
+
+	if (self->InternalFieldCount() != 1) {
+		return NULL;
+	}
+
+	return static_cast<v8js_php_iterator *>(self->GetAlignedPointerFromInternalField(0));
+}
+/* }}} */
+
+static void v8js_php_iterator_set_result(const v8::FunctionCallbackInfo<v8::Value>& info, v8::Local<v8::Value> value, bool done) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
+	v8::Local<v8::Object> result = v8::Object::New(isolate);
+
+	result->Set(v8_context, V8JS_SYM("value"), value);
+	result->Set(v8_context, V8JS_SYM("done"), V8JS_BOOL(done));
+	info.GetReturnValue().Set(result);
+}
+/* }}} */
+
+/* iterator.next(), rewinds on first call, i.e. like foreach does */
+static void v8js_php_iterator_next(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8js_php_iterator *iter = v8js_php_iterator_fetch(info);
+	zval value;
+	bool done = true;
+
+	if (!iter) {
+		return;
+	}
+
+	ZVAL_UNDEF(&value);
+
+	if (iter->it) {
+		zend_object_iterator *it = iter->it;
+
+		isolate->Exit();
+		{
+			v8::Unlocker unlocker(isolate);
+
+			zend_try {
+				if (!iter->started) {
+					iter->started = true;
+
+					if (it->funcs->rewind) {
+						it->funcs->rewind(it);
+					}
+				} else {
+					it->funcs->move_forward(it);
+				}
+
+				if (!EG(exception) && it->funcs->valid(it) == SUCCESS) {
+					zval *data = it->funcs->get_current_data(it);
+
+					if (data && !EG(exception)) {
+						ZVAL_COPY_DEREF(&value, data);
+						done = false;
+					}
+				}
+			}
+			zend_catch {
+				v8js_terminate_execution(isolate);
+				V8JSG(fatal_error_abort) = 1;
+			}
+			zend_end_try();
+		}
+		isolate->Enter();
+	}
+
+	if (EG(exception)) {
+		zval_ptr_dtor(&value);
+		v8js_php_iterator_release(iter);
+		v8js_php_iterator_exception(isolate, iter->ctx);
+		return;
+	}
+
+	if (done) {
+		/* Exhausted, don't keep the PHP iterator until JS' GC kicks in */
+		v8js_php_iterator_release(iter);
+		v8js_php_iterator_set_result(info, V8JS_UNDEFINED, true);
+		return;
+	}
+
+	v8js_php_iterator_set_result(info, zval_to_v8js(&value, isolate), false);
+	zval_ptr_dtor(&value);
+}
+/* }}} */
+
+/* iterator.return(), called by for...of on break */
+static void v8js_php_iterator_return(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8js_php_iterator *iter = v8js_php_iterator_fetch(info);
+
+	if (iter) {
+		v8js_php_iterator_release(iter);
+	}
+
+	v8js_php_iterator_set_result(info, info.Length() > 0 ? info[0] : V8JS_UNDEFINED, true);
+}
+/* }}} */
+
+/* iterator[Symbol.iterator](), iterators are iterable themselves */
+static void v8js_php_iterator_self(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	info.GetReturnValue().Set(info.This());
+}
+/* }}} */
+
+/* obj[Symbol.iterator]() of wrapped Traversable objects */
+static void v8js_traversable_get_iterator(const v8::FunctionCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
+	v8js_ctx *ctx = (v8js_ctx *) isolate->GetData(0);
+	v8::Local<v8::Object> self = info.This();
+	zend_object_iterator *it = NULL;
+
+	if (self->InternalFieldCount() != 2) {
+		isolate->ThrowException(v8::Exception::TypeError(V8JS_SYM("Illegal invocation")));
+		return;
+	}
+
+	zend_object *object = reinterpret_cast<zend_object *>(self->GetAlignedPointerFromInternalField(1));
+
+	/* The function may be called on any wrapped object, e.g. using call() */
+	if (!object || !object->ce->get_iterator || !instanceof_function(object->ce, zend_ce_traversable)) {
+		isolate->ThrowException(v8::Exception::TypeError(V8JS_SYM("Object is not Traversable")));
+		return;
+	}
+
+	zval zobject;
+	ZVAL_OBJ(&zobject, object);
+
+	isolate->Exit();
+	{
+		v8::Unlocker unlocker(isolate);
+
+		zend_try {
+			it = object->ce->get_iterator(object->ce, &zobject, 0);
+		}
+		zend_catch {
+			v8js_terminate_execution(isolate);
+			V8JSG(fatal_error_abort) = 1;
+		}
+		zend_end_try();
+	}
+	isolate->Enter();
+
+	if (EG(exception)) {
+		if (it) {
+			zend_iterator_dtor(it);
+		}
+
+		v8js_php_iterator_exception(isolate, ctx);
+		return;
+	}
+
+	if (!it) {
+		return;
+	}
+
+	v8::Local<v8::FunctionTemplate> tmpl;
+
+	if (ctx->iterator_tmpl.IsEmpty()) {
+		tmpl = v8::FunctionTemplate::New(isolate);
+		v8::Local<v8::Signature> sig = v8::Signature::New(isolate, tmpl);
+		v8::Local<v8::ObjectTemplate> inst_tpl = tmpl->InstanceTemplate();
+
+		inst_tpl->SetInternalFieldCount(1);
+		inst_tpl->Set(V8JS_SYM("next"), v8::FunctionTemplate::New(isolate, v8js_php_iterator_next, v8::Local<v8::Value>(), sig), v8::DontEnum);
+		inst_tpl->Set(V8JS_SYM("return"), v8::FunctionTemplate::New(isolate, v8js_php_iterator_return, v8::Local<v8::Value>(), sig), v8::DontEnum);
+		inst_tpl->Set(v8::Symbol::GetIterator(isolate), v8::FunctionTemplate::New(isolate, v8js_php_iterator_self), v8::DontEnum);
+		ctx->iterator_tmpl.Reset(isolate, tmpl);
+	} else {
+		tmpl = v8::Local<v8::FunctionTemplate>::New(isolate, ctx->iterator_tmpl);
+	}
+
+	v8::Local<v8::Object> result;
+
+	if (!tmpl->InstanceTemplate()->NewInstance(v8_context).ToLocal(&result)) {
+		zend_iterator_dtor(it);
+		return;
+	}
+
+	v8js_php_iterator *iter = new v8js_php_iterator();
+	iter->it = it;
+	iter->started = false;
+	iter->ctx = ctx;
+	iter->pos = ctx->php_iterators.insert(ctx->php_iterators.end(), iter);
+
+	result->SetAlignedPointerInInternalField(0, iter);
+	iter->handle.Reset(isolate, result);
+	iter->handle.SetWeak(iter, v8js_php_iterator_weak_callback, v8::WeakCallbackType::kParameter);
+
+	info.GetReturnValue().Set(result);
+}
+/* }}} */
+
+void v8js_iterator_export_register(v8::Isolate *isolate, v8::Local<v8::ObjectTemplate> inst_tpl) /* {{{ */
+{
+	inst_tpl->Set(v8::Symbol::GetIterator(isolate),
+		v8::FunctionTemplate::New(isolate, v8js_traversable_get_iterator), v8::DontEnum);
+}
+/* }}} */
+
+void v8js_iterator_export_free(v8js_ctx *ctx) /* {{{ */
+{
+	while (!ctx->php_iterators.empty()) {
+		v8js_php_iterator_free(ctx->php_iterators.front());
+	}
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * mode: c++
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
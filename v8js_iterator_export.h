@@ -0,0 +1,41 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 2016 The PHP Group                                     |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_ITERATOR_EXPORT_H
+#define V8JS_ITERATOR_EXPORT_H
+
+/* JS iterator backed by a zend_object_iterator, see v8js_iterator_export.cc */
+struct v8js_php_iterator {
+	zend_object_iterator *it;
+	bool started;
+	v8js_ctx *ctx;
+	v8::Persistent<v8::Object> handle;
+	std::list<v8js_php_iterator *>::iterator pos;
+};
+
+/* Add Symbol.iterator to the instance template of a Traversable class */
+void v8js_iterator_export_register(v8::Isolate *isolate, v8::Local<v8::ObjectTemplate> inst_tpl);
+
+/* Release iterators still referenced from JS */
+void v8js_iterator_export_free(v8js_ctx *ctx);
+
+#endif /* V8JS_ITERATOR_EXPORT_H */
+
+/*
+ * Local variables:
+ * mode: c++
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
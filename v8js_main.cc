@@ -25,7 +25,11 @@ extern "C" {
 }
 
 #include "v8js_class.h"
+#include "v8js_console.h"
 #include "v8js_exceptions.h"
+#include "v8js_metrics.h"
+#include "v8js_prewarm.h"
+#include "v8js_tracing.h"
 #include "v8js_v8object_class.h"
 
 ZEND_DECLARE_MODULE_GLOBALS(v8js)
@@ -105,6 +109,20 @@ static ZEND_INI_MH(v8js_OnUpdateUseDate) /* {{{ */
 }
 /* }}} */
 
+static ZEND_INI_MH(v8js_OnUpdateEnumAsValue) /* {{{ */
+{
+	V8JSG(enum_as_value) = v8js_ini_to_bool(new_value);
+	return SUCCESS;
+}
+/* }}} */
+
+static ZEND_INI_MH(v8js_OnUpdateImmutableArrayCache) /* {{{ */
+{
+	V8JSG(immutable_array_cache) = v8js_ini_to_bool(new_value);
+	return SUCCESS;
+}
+/* }}} */
+
 static ZEND_INI_MH(v8js_OnUpdateUseArrayAccess) /* {{{ */
 {
 	V8JSG(use_array_access) = v8js_ini_to_bool(new_value);
@@ -112,11 +130,60 @@ static ZEND_INI_MH(v8js_OnUpdateUseArrayAccess) /* {{{ */
 }
 /* }}} */
 
+static ZEND_INI_MH(v8js_OnUpdateConsoleLevel) /* {{{ */
+{
+	V8JSG(console_level) = v8js_console_parse_level(ZSTR_VAL(new_value), ZSTR_LEN(new_value));
+	return SUCCESS;
+}
+/* }}} */
+
+static ZEND_INI_MH(v8js_OnUpdateConsoleBufferSize) /* {{{ */
+{
+	V8JSG(console_buffer_size) = atol(ZSTR_VAL(new_value));
+	return SUCCESS;
+}
+/* }}} */
+
+static ZEND_INI_MH(v8js_OnUpdateMemoizeCacheSize) /* {{{ */
+{
+	V8JSG(memoize_cache_size) = atol(ZSTR_VAL(new_value));
+	return SUCCESS;
+}
+/* }}} */
+
+static ZEND_INI_MH(v8js_OnUpdateProfileCallbacks) /* {{{ */
+{
+	V8JSG(profile_callbacks) = v8js_ini_to_bool(new_value);
+	return SUCCESS;
+}
+/* }}} */
+
+static ZEND_INI_MH(v8js_OnUpdateSlowlogThreshold) /* {{{ */
+{
+	V8JSG(slowlog_threshold) = atol(ZSTR_VAL(new_value));
+	return SUCCESS;
+}
+/* }}} */
+
 ZEND_INI_BEGIN() /* {{{ */
 	ZEND_INI_ENTRY("v8js.flags", NULL, ZEND_INI_ALL, v8js_OnUpdateV8Flags)
 	ZEND_INI_ENTRY("v8js.icudtl_dat_path", NULL, ZEND_INI_ALL, v8js_OnUpdateIcudatPath)
 	ZEND_INI_ENTRY("v8js.use_date", "0", ZEND_INI_ALL, v8js_OnUpdateUseDate)
 	ZEND_INI_ENTRY("v8js.use_array_access", "0", ZEND_INI_ALL, v8js_OnUpdateUseArrayAccess)
+	ZEND_INI_ENTRY("v8js.enum_as_value", "0", ZEND_INI_ALL, v8js_OnUpdateEnumAsValue)
+	ZEND_INI_ENTRY("v8js.immutable_array_cache", "0", ZEND_INI_ALL, v8js_OnUpdateImmutableArrayCache)
+	ZEND_INI_ENTRY("v8js.console", "1", ZEND_INI_ALL, NULL)
+	ZEND_INI_ENTRY("v8js.console_level", "info", ZEND_INI_ALL, v8js_OnUpdateConsoleLevel)
+	ZEND_INI_ENTRY("v8js.console_buffer_size", "1024", ZEND_INI_ALL, v8js_OnUpdateConsoleBufferSize)
+	ZEND_INI_ENTRY("v8js.memoize_cache_size", "256", ZEND_INI_ALL, v8js_OnUpdateMemoizeCacheSize)
+	ZEND_INI_ENTRY("v8js.profile_callbacks", "0", ZEND_INI_ALL, v8js_OnUpdateProfileCallbacks)
+	ZEND_INI_ENTRY("v8js.trace_categories", "v8js,v8", ZEND_INI_ALL, NULL)
+	ZEND_INI_ENTRY("v8js.metrics", "0", ZEND_INI_SYSTEM, NULL)
+	ZEND_INI_ENTRY("v8js.slowlog_threshold_ms", "0", ZEND_INI_ALL, v8js_OnUpdateSlowlogThreshold)
+	ZEND_INI_ENTRY("v8js.slowlog", NULL, ZEND_INI_ALL, NULL)
+	ZEND_INI_ENTRY("v8js.prewarm_count", "0", ZEND_INI_SYSTEM, NULL)
+	ZEND_INI_ENTRY("v8js.prewarm_snapshot", NULL, ZEND_INI_SYSTEM, NULL)
+	ZEND_INI_ENTRY("v8js.prewarm_script", NULL, ZEND_INI_SYSTEM, NULL)
 ZEND_INI_END()
 /* }}} */
 
@@ -142,6 +209,11 @@ PHP_MINIT_FUNCTION(v8js)
 
 	REGISTER_INI_ENTRIES();
 
+	v8js_immutable_array_cache_init();
+
+	/* Before php-fpm & co. fork their workers */
+	v8js_metrics_init();
+
 	return SUCCESS;
 }
 /* }}} */
@@ -152,6 +224,8 @@ static PHP_MSHUTDOWN_FUNCTION(v8js)
 {
 	UNREGISTER_INI_ENTRIES();
 
+	v8js_metrics_shutdown();
+
 	bool v8_initialized;
 
 #ifdef ZTS
@@ -161,6 +235,7 @@ static PHP_MSHUTDOWN_FUNCTION(v8js)
 #endif
 
 	if(v8_initialized) {
+		v8js_prewarm_shutdown();
 		v8::V8::Dispose();
 		v8::V8::ShutdownPlatform();
 		// @fixme call virtual destructor somehow
@@ -176,6 +251,24 @@ static PHP_MSHUTDOWN_FUNCTION(v8js)
 }
 /* }}} */
 
+/* {{{ PHP_RINIT_FUNCTION
+ */
+static PHP_RINIT_FUNCTION(v8js)
+{
+	/* First request of this worker (i.e. after php-fpm forked it),
+	 * create the instances V8Js::__construct() may then adopt */
+	if (!V8JSG(prewarm_done)) {
+		V8JSG(prewarm_done) = true;
+
+		if (INI_INT("v8js.prewarm_count") > 0) {
+			v8js_prewarm_fill(INI_INT("v8js.prewarm_count"));
+		}
+	}
+
+	return SUCCESS;
+}
+/* }}} */
+
 /* {{{ PHP_RSHUTDOWN_FUNCTION
  */
 static PHP_RSHUTDOWN_FUNCTION(v8js)
@@ -190,6 +283,18 @@ static PHP_RSHUTDOWN_FUNCTION(v8js)
 	}
 
 	V8JSG(fatal_error_abort) = 0;
+	V8JSG(in_async_fiber) = false;
+
+	/* User classes (and hence their zend_class_entry) go away with the request */
+	V8JSG(export_plans).clear();
+
+	v8js_metrics_flush();
+
+	/* Finish trace file of a session not stopped explicitly */
+	if (V8JSG(tracing_started)) {
+		v8js_tracing_stop();
+		V8JSG(tracing_started) = false;
+	}
 
 	return SUCCESS;
 }
@@ -206,6 +311,8 @@ static PHP_MINFO_FUNCTION(v8js)
 	php_info_print_table_header(2, "Version", PHP_V8JS_VERSION);
 	php_info_print_table_end();
 
+	v8js_metrics_info();
+
 	DISPLAY_INI_ENTRIES();
 }
 /* }}} */
@@ -237,6 +344,24 @@ static PHP_GINIT_FUNCTION(v8js)
 	new(&v8js_globals->timer_stack) std::deque<v8js_timer_ctx *>;
 
 	v8js_globals->fatal_error_abort = 0;
+	v8js_globals->in_async_fiber = false;
+	v8js_globals->tracing_started = false;
+	v8js_globals->metrics_callbacks = 0;
+	v8js_globals->metrics_conversion_bytes = 0;
+
+	new(&v8js_globals->export_plans) std::unordered_map<zend_class_entry *, v8js_export_plan>;
+	new(&v8js_globals->prewarm_pool) std::vector<v8js_prewarmed *>;
+	v8js_globals->prewarm_done = false;
+	v8js_globals->prewarm_snapshot_data = NULL;
+
+	v8js_globals->console_level = 0;
+	v8js_globals->console_buffer_size = 0;
+	v8js_globals->memoize_cache_size = 0;
+	v8js_globals->profile_callbacks = false;
+	v8js_globals->enum_as_value = false;
+	v8js_globals->immutable_array_cache = false;
+	v8js_globals->immutable_array_generation = 0;
+	v8js_globals->slowlog_threshold = 0;
 #endif
 }
 /* }}} */
@@ -248,12 +373,20 @@ static PHP_GSHUTDOWN_FUNCTION(v8js)
 #ifdef ZTS
 	v8js_globals->timer_stack.~deque();
 	v8js_globals->timer_mutex.~mutex();
+	v8js_globals->export_plans.~unordered_map();
+	v8js_globals->prewarm_pool.~vector();
 #endif
 }
 /* }}} */
 
+/* {{{ arginfo */
+ZEND_BEGIN_ARG_INFO(arginfo_v8js_metrics, 0)
+ZEND_END_ARG_INFO()
+/* }}} */
+
 /* {{{ v8js_functions[] */
 static const zend_function_entry v8js_functions[] = {
+	PHP_FE(v8js_metrics,	arginfo_v8js_metrics)
 	{NULL, NULL, NULL}
 };
 /* }}} */
@@ -268,7 +401,7 @@ zend_module_entry v8js_module_entry = {
 	v8js_functions,
 	PHP_MINIT(v8js),
 	PHP_MSHUTDOWN(v8js),
-	NULL,
+	PHP_RINIT(v8js),
 	PHP_RSHUTDOWN(v8js),
 	PHP_MINFO(v8js),
 	PHP_V8JS_VERSION,
@@ -0,0 +1,264 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_memoize.h"
+
+/* Arrays nested deeper than this are not cached */
+#define V8JS_MEMOIZE_MAX_DEPTH 64
+
+static v8::Local<v8::Private> v8js_memoize_private(v8::Isolate *isolate) /* {{{ */
+{
+	return v8::Private::ForApi(isolate, V8JS_SYM("v8js::memoize"));
+}
+/* }}} */
+
+int v8js_memoize_mark(v8js_ctx *c, v8::Local<v8::Function> fn, bool enable) /* {{{ */
+{
+	v8::Isolate *isolate = c->isolate;
+	v8::Local<v8::Context> v8_context = isolate->GetCurrentContext();
+	v8::Local<v8::Private> key = v8js_memoize_private(isolate);
+
+	if (!enable) {
+		fn->DeletePrivate(v8_context, key).FromMaybe(false);
+		return 0;
+	}
+
+	int memo_id = v8js_memoize_id(c, fn);
+
+	if (!memo_id) {
+		/* Ids are never re-used, hence stale entries of functions that were
+		 * un-memoized simply age out of the cache. */
+		memo_id = ++ c->memo_next_id;
+		fn->SetPrivate(v8_context, key, V8JS_INT(memo_id)).FromMaybe(false);
+	}
+
+	return memo_id;
+}
+/* }}} */
+
+int v8js_memoize_id(v8js_ctx *c, v8::Local<v8::Function> fn) /* {{{ */
+{
+	if (!c->memo_next_id) {
+		/* Nothing memoized so far, don't bother looking */
+		return 0;
+	}
+
+	v8::Isolate *isolate = c->isolate;
+	v8::Local<v8::Value> value;
+
+	if (!fn->GetPrivate(isolate->GetCurrentContext(), v8js_memoize_private(isolate)).ToLocal(&value) || !value->IsInt32()) {
+		return 0;
+	}
+
+	return value.As<v8::Int32>()->Value();
+}
+/* }}} */
+
+static inline void v8js_memoize_append(std::string &key, const void *data, size_t len) /* {{{ */
+{
+	key.append(static_cast<const char *>(data), len);
+}
+/* }}} */
+
+/* Append a structural, type-tagged encoding of the passed value to key.
+ * Two values produce the same encoding if and only if they convert to
+ * equal JS values. */
+static bool v8js_memoize_encode(zval *value, std::string &key, int depth) /* {{{ */
+{
+	ZVAL_DEREF(value);
+
+	switch (Z_TYPE_P(value)) {
+		case IS_UNDEF:
+		case IS_NULL:
+			key.push_back('n');
+			return true;
+
+		case IS_FALSE:
+			key.push_back('f');
+			return true;
+
+		case IS_TRUE:
+			key.push_back('t');
+			return true;
+
+		case IS_LONG:
+			key.push_back('l');
+			v8js_memoize_append(key, &Z_LVAL_P(value), sizeof(zend_long));
+			return true;
+
+		case IS_DOUBLE:
+			key.push_back('d');
+			v8js_memoize_append(key, &Z_DVAL_P(value), sizeof(double));
+			return true;
+
+		case IS_STRING:
+			key.push_back('s');
+			v8js_memoize_append(key, &Z_STRLEN_P(value), sizeof(size_t));
+			v8js_memoize_append(key, Z_STRVAL_P(value), Z_STRLEN_P(value));
+			return true;
+
+		case IS_ARRAY: {
+			zend_ulong index;
+			zend_string *str_key;
+			zval *data;
+			uint32_t count = zend_hash_num_elements(Z_ARRVAL_P(value));
+
+			if (depth >= V8JS_MEMOIZE_MAX_DEPTH) {
+				return false;
+			}
+
+			key.push_back('a');
+			v8js_memoize_append(key, &count, sizeof(count));
+
+			ZEND_HASH_FOREACH_KEY_VAL(Z_ARRVAL_P(value), index, str_key, data) {
+				if (str_key) {
+					key.push_back('k');
+					v8js_memoize_append(key, &ZSTR_LEN(str_key), sizeof(size_t));
+					v8js_memoize_append(key, ZSTR_VAL(str_key), ZSTR_LEN(str_key));
+				}
+				else {
+					key.push_back('i');
+					v8js_memoize_append(key, &index, sizeof(zend_ulong));
+				}
+
+				if (!v8js_memoize_encode(data, key, depth + 1)) {
+					return false;
+				}
+			} ZEND_HASH_FOREACH_END();
+
+			return true;
+		}
+
+		default:
+			/* Objects (and resources) have identity and might be mutated
+			 * behind our back, calls involving them are never cached. */
+			return false;
+	}
+}
+/* }}} */
+
+/* Check whether a call result is a plain value, that can be handed out
+ * more than once */
+static bool v8js_memoize_cacheable(zval *value, int depth) /* {{{ */
+{
+	zval *data;
+
+	ZVAL_DEREF(value);
+
+	if (Z_TYPE_P(value) == IS_OBJECT || Z_TYPE_P(value) == IS_RESOURCE) {
+		return false;
+	}
+
+	if (Z_TYPE_P(value) != IS_ARRAY) {
+		return true;
+	}
+
+	if (depth >= V8JS_MEMOIZE_MAX_DEPTH) {
+		return false;
+	}
+
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(value), data) {
+		if (!v8js_memoize_cacheable(data, depth + 1)) {
+			return false;
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	return true;
+}
+/* }}} */
+
+bool v8js_memoize_key(int memo_id, long flags, zval *argv, int argc, std::string &key) /* {{{ */
+{
+	key.reserve(sizeof(memo_id) + sizeof(flags) + 16 * argc);
+	v8js_memoize_append(key, &memo_id, sizeof(memo_id));
+	v8js_memoize_append(key, &flags, sizeof(flags));
+
+	for (int i = 0; i < argc; i ++) {
+		if (!v8js_memoize_encode(&argv[i], key, 0)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+/* }}} */
+
+bool v8js_memoize_lookup(v8js_ctx *c, const std::string &key, zval *return_value) /* {{{ */
+{
+	std::unordered_map<std::string, v8js_memo_entry>::iterator it = c->memo_cache.find(key);
+
+	if (it == c->memo_cache.end()) {
+		return false;
+	}
+
+	/* Move to front of LRU list */
+	c->memo_lru.splice(c->memo_lru.begin(), c->memo_lru, it->second.lru);
+
+	zval_ptr_dtor(return_value);
+	ZVAL_COPY(return_value, &it->second.result);
+	return true;
+}
+/* }}} */
+
+void v8js_memoize_store(v8js_ctx *c, const std::string &key, zval *value) /* {{{ */
+{
+	if (V8JSG(memoize_cache_size) <= 0 || !v8js_memoize_cacheable(value, 0)) {
+		return;
+	}
+
+	while (c->memo_cache.size() >= static_cast<size_t>(V8JSG(memoize_cache_size))) {
+		std::unordered_map<std::string, v8js_memo_entry>::iterator victim = c->memo_cache.find(*c->memo_lru.back());
+		zval_ptr_dtor(&victim->second.result);
+		c->memo_lru.pop_back();
+		c->memo_cache.erase(victim);
+	}
+
+	std::pair<std::unordered_map<std::string, v8js_memo_entry>::iterator, bool> res =
+		c->memo_cache.emplace(key, v8js_memo_entry());
+
+	if (!res.second) {
+		/* Re-entrant call of the same function stored it already */
+		return;
+	}
+
+	ZVAL_COPY(&res.first->second.result, value);
+	c->memo_lru.push_front(&res.first->first);
+	res.first->second.lru = c->memo_lru.begin();
+}
+/* }}} */
+
+void v8js_memoize_clear(v8js_ctx *c) /* {{{ */
+{
+	for (std::unordered_map<std::string, v8js_memo_entry>::iterator it = c->memo_cache.begin();
+		 it != c->memo_cache.end(); ++it) {
+		zval_ptr_dtor(&it->second.result);
+	}
+
+	c->memo_cache.clear();
+	c->memo_lru.clear();
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
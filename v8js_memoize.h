@@ -0,0 +1,47 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_MEMOIZE_H
+#define V8JS_MEMOIZE_H
+
+/* Mark (or unmark) a JS function as memoized, returns the function's memo id
+ * (0 if memoization was disabled). */
+int v8js_memoize_mark(v8js_ctx *c, v8::Local<v8::Function> fn, bool enable);
+
+/* Fetch memo id of a JS function, 0 if it is not memoized */
+int v8js_memoize_id(v8js_ctx *c, v8::Local<v8::Function> fn);
+
+/* Build the cache key for a call; returns false if the arguments can't be
+ * hashed structurally (e.g. contain objects), i.e. the call must not be cached. */
+bool v8js_memoize_key(int memo_id, long flags, zval *argv, int argc, std::string &key);
+
+/* Look up a cached call result, copying it into return_value on hit */
+bool v8js_memoize_lookup(v8js_ctx *c, const std::string &key, zval *return_value);
+
+/* Store call result (if it is a plain value), evicting the least recently
+ * used entry if the cache is full */
+void v8js_memoize_store(v8js_ctx *c, const std::string &key, zval *value);
+
+/* Release all cached results */
+void v8js_memoize_clear(v8js_ctx *c);
+
+#endif /* V8JS_MEMOIZE_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
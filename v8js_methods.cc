@@ -18,7 +18,12 @@
 
 #include "php_v8js_macros.h"
 #include "v8js_commonjs.h"
+#include "v8js_console.h"
+#include "v8js_dtrace.h"
+#include "v8js_encoding.h"
 #include "v8js_exceptions.h"
+#include "v8js_metrics.h"
+#include "v8js_tracing.h"
 
 extern "C" {
 #include "zend_exceptions.h"
@@ -411,6 +416,9 @@ V8JS_METHOD(require)
 
     // If we have already loaded and cached this module then use it
 	if (c->modules_loaded.count(normalised_module_id) > 0) {
+		V8JS_PROBE2(require, normalised_module_id, 1);
+		V8JS_METRIC_INC(require_cache_hits);
+
 		v8::Persistent<v8::Value> newobj;
 		newobj.Reset(isolate, c->modules_loaded[normalised_module_id]);
 
@@ -424,6 +432,8 @@ V8JS_METHOD(require)
 	}
 
 	// Callback to PHP to load the module code
+	V8JS_PROBE2(require, normalised_module_id, 0);
+	v8js_trace_scope trace_scope("require", "module", normalised_module_id);
 
 	zval module_code;
 	int call_result;
@@ -630,6 +640,15 @@ void v8js_register_methods(v8::Local<v8::ObjectTemplate> global, v8js_ctx *c) /*
 
 	v8::Local<v8::String> base_path = V8JS_STRL("", 0);
 	global->Set(V8JS_SYM("require"), v8::FunctionTemplate::New(isolate, V8JS_MN(require), base_path), v8::ReadOnly);
+
+	/* TextEncoder, TextDecoder, atob & btoa */
+	v8js_register_encoding(global, isolate);
+
+	/* console.log & friends, buffered until V8Js::drainConsole; with
+	 * v8js.console=0 scripts keep installing their own (if undefined) */
+	if (INI_BOOL("v8js.console")) {
+		v8js_register_console(global, isolate);
+	}
 }
 /* }}} */
 
@@ -0,0 +1,252 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <atomic>
+#include <cinttypes>
+
+#include "php_v8js_macros.h"
+#include "v8js_metrics.h"
+
+extern "C" {
+#include "php_ini.h"
+#include "ext/standard/info.h"
+}
+
+#ifndef PHP_WIN32
+#include <sys/mman.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
+struct v8js_metrics_segment {
+	std::atomic<uint64_t> since;
+	std::atomic<uint64_t> counters[V8JS_METRIC_COUNT];
+	std::atomic<uint64_t> histograms[V8JS_METRIC_HISTOGRAM_COUNT][V8JS_METRICS_BUCKETS];
+};
+
+static const char *v8js_metric_names[] = {
+#define V8JS_METRIC_NAME(name) #name,
+	V8JS_METRICS(V8JS_METRIC_NAME)
+#undef V8JS_METRIC_NAME
+};
+
+static const char *v8js_metric_histogram_names[] = {
+	"execution_us",
+	"gc_pause_us",
+};
+
+static v8js_metrics_segment *v8js_metrics_shm = NULL;
+static bool v8js_metrics_shared = false;
+bool v8js_metrics_active = false;
+
+void v8js_metrics_init() /* {{{ */
+{
+	if (!INI_BOOL("v8js.metrics")) {
+		return;
+	}
+
+	void *segment = NULL;
+
+#if !defined(PHP_WIN32) && defined(MAP_ANONYMOUS)
+	segment = mmap(NULL, sizeof(v8js_metrics_segment), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	if (segment == MAP_FAILED) {
+		segment = NULL;
+	}
+	else {
+		v8js_metrics_shared = true;
+	}
+#endif
+
+	if (!segment) {
+		/* No shared memory, still count for this process */
+		segment = pecalloc(1, sizeof(v8js_metrics_segment), 1);
+	}
+
+	/* Anonymous mappings are zero-filled already */
+	v8js_metrics_shm = static_cast<v8js_metrics_segment *>(segment);
+	v8js_metrics_active = true;
+	v8js_metrics_shm->since.store(static_cast<uint64_t>(time(NULL)), std::memory_order_relaxed);
+}
+/* }}} */
+
+void v8js_metrics_shutdown() /* {{{ */
+{
+	if (!v8js_metrics_shm) {
+		return;
+	}
+
+#if !defined(PHP_WIN32) && defined(MAP_ANONYMOUS)
+	if (v8js_metrics_shared) {
+		munmap(v8js_metrics_shm, sizeof(v8js_metrics_segment));
+	}
+	else
+#endif
+	{
+		pefree(v8js_metrics_shm, 1);
+	}
+
+	v8js_metrics_shm = NULL;
+	v8js_metrics_active = false;
+}
+/* }}} */
+
+void v8js_metrics_add(v8js_metric metric, uint64_t value) /* {{{ */
+{
+	if (v8js_metrics_shm) {
+		v8js_metrics_shm->counters[metric].fetch_add(value, std::memory_order_relaxed);
+	}
+}
+/* }}} */
+
+void v8js_metrics_observe(v8js_metric_histogram histogram, uint64_t duration_ns) /* {{{ */
+{
+	if (!v8js_metrics_shm) {
+		return;
+	}
+
+	/* Bucket i counts durations shorter than 2^i microseconds */
+	uint64_t us = duration_ns / 1000;
+	int bucket = 0;
+
+	while (us && bucket < V8JS_METRICS_BUCKETS - 1) {
+		us >>= 1;
+		bucket ++;
+	}
+
+	v8js_metrics_shm->histograms[histogram][bucket].fetch_add(1, std::memory_order_relaxed);
+}
+/* }}} */
+
+void v8js_metrics_flush() /* {{{ */
+{
+	if (V8JSG(metrics_callbacks)) {
+		v8js_metrics_add(V8JS_METRIC_callbacks, V8JSG(metrics_callbacks));
+		V8JSG(metrics_callbacks) = 0;
+	}
+
+	if (V8JSG(metrics_conversion_bytes)) {
+		v8js_metrics_add(V8JS_METRIC_conversion_bytes, V8JSG(metrics_conversion_bytes));
+		V8JSG(metrics_conversion_bytes) = 0;
+	}
+}
+/* }}} */
+
+static thread_local uint64_t v8js_metrics_gc_start;
+
+static void v8js_metrics_gc_prologue(v8::Isolate *isolate, v8::GCType type, v8::GCCallbackFlags flags) /* {{{ */
+{
+	v8js_metrics_gc_start = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+/* }}} */
+
+static void v8js_metrics_gc_epilogue(v8::Isolate *isolate, v8::GCType type, v8::GCCallbackFlags flags) /* {{{ */
+{
+	uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	uint64_t duration = v8js_metrics_gc_start ? now - v8js_metrics_gc_start : 0;
+
+	V8JS_METRIC_INC(gc_pauses);
+	v8js_metrics_add(V8JS_METRIC_gc_pause_us, duration / 1000);
+	v8js_metrics_observe(V8JS_METRIC_HISTOGRAM_GC_PAUSE, duration);
+}
+/* }}} */
+
+void v8js_metrics_register_gc(v8::Isolate *isolate) /* {{{ */
+{
+	if (!v8js_metrics_shm) {
+		return;
+	}
+
+	isolate->AddGCPrologueCallback(v8js_metrics_gc_prologue);
+	isolate->AddGCEpilogueCallback(v8js_metrics_gc_epilogue);
+}
+/* }}} */
+
+void v8js_metrics_info() /* {{{ */
+{
+	char buf[32];
+
+	if (!v8js_metrics_shm) {
+		return;
+	}
+
+	v8js_metrics_flush();
+
+	php_info_print_table_start();
+	php_info_print_table_header(2, "V8Js metrics", v8js_metrics_shared ? "all processes" : "this process");
+
+	for (int i = 0; i < V8JS_METRIC_COUNT; i ++) {
+		snprintf(buf, sizeof(buf), "%" PRIu64, v8js_metrics_shm->counters[i].load(std::memory_order_relaxed));
+		php_info_print_table_row(2, v8js_metric_names[i], buf);
+	}
+
+	php_info_print_table_end();
+}
+/* }}} */
+
+/* {{{ proto array|false v8js_metrics()
+ */
+PHP_FUNCTION(v8js_metrics)
+{
+	if (zend_parse_parameters_none() == FAILURE) {
+		return;
+	}
+
+	if (!v8js_metrics_shm) {
+		RETURN_FALSE;
+	}
+
+	v8js_metrics_flush();
+
+	array_init_size(return_value, V8JS_METRIC_COUNT + V8JS_METRIC_HISTOGRAM_COUNT + 2);
+	add_assoc_long(return_value, "since", static_cast<zend_long>(v8js_metrics_shm->since.load(std::memory_order_relaxed)));
+	add_assoc_bool(return_value, "shared", v8js_metrics_shared);
+
+	for (int i = 0; i < V8JS_METRIC_COUNT; i ++) {
+		add_assoc_long(return_value, v8js_metric_names[i],
+			static_cast<zend_long>(v8js_metrics_shm->counters[i].load(std::memory_order_relaxed)));
+	}
+
+	for (int i = 0; i < V8JS_METRIC_HISTOGRAM_COUNT; i ++) {
+		zval histogram;
+		array_init(&histogram);
+
+		/* keyed by upper bound in microseconds, empty buckets are left out */
+		for (int j = 0; j < V8JS_METRICS_BUCKETS; j ++) {
+			uint64_t count = v8js_metrics_shm->histograms[i][j].load(std::memory_order_relaxed);
+
+			if (count) {
+				add_index_long(&histogram, ZEND_LONG(1) << j, static_cast<zend_long>(count));
+			}
+		}
+
+		add_assoc_zval(return_value, v8js_metric_histogram_names[i], &histogram);
+	}
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
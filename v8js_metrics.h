@@ -0,0 +1,82 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_METRICS_H
+#define V8JS_METRICS_H
+
+/* Process-wide counters, kept in a shared memory segment that is mapped
+ * at MINIT, hence shared by all workers forked afterwards (e.g. php-fpm). */
+#define V8JS_METRICS(X) \
+	X(executions) \
+	X(compilations) \
+	X(code_cache_hits) \
+	X(code_cache_rejects) \
+	X(require_cache_hits) \
+	X(isolate_creations) \
+	X(time_limit_terminations) \
+	X(memory_limit_terminations) \
+	X(gc_pauses) \
+	X(gc_pause_us) \
+	X(callbacks) \
+	X(conversion_bytes)
+
+enum v8js_metric {
+#define V8JS_METRIC_ENUM(name) V8JS_METRIC_##name,
+	V8JS_METRICS(V8JS_METRIC_ENUM)
+#undef V8JS_METRIC_ENUM
+	V8JS_METRIC_COUNT
+};
+
+/* Histograms, with log2 microsecond buckets */
+enum v8js_metric_histogram {
+	V8JS_METRIC_HISTOGRAM_EXECUTION,
+	V8JS_METRIC_HISTOGRAM_GC_PAUSE,
+	V8JS_METRIC_HISTOGRAM_COUNT
+};
+
+#define V8JS_METRICS_BUCKETS 24
+
+void v8js_metrics_init();
+void v8js_metrics_shutdown();
+
+/* Whether the segment is mapped (v8js.metrics=1), to skip timing otherwise */
+extern bool v8js_metrics_active;
+
+/* Add to shared counter directly, for infrequent events */
+void v8js_metrics_add(v8js_metric metric, uint64_t value);
+void v8js_metrics_observe(v8js_metric_histogram histogram, uint64_t duration_ns);
+
+#define V8JS_METRIC_INC(name)	v8js_metrics_add(V8JS_METRIC_##name, 1)
+
+/* Frequent events are counted in module globals first and
+ * added to the shared segment by v8js_metrics_flush() */
+#define V8JS_METRIC_LOCAL_ADD(name, value)	(V8JSG(metrics_##name) += (value))
+void v8js_metrics_flush();
+
+/* GC prologue/epilogue callbacks, counting gc_pauses */
+void v8js_metrics_register_gc(v8::Isolate *isolate);
+
+void v8js_metrics_info();
+
+PHP_FUNCTION(v8js_metrics);
+
+#endif /* V8JS_METRICS_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -18,9 +18,14 @@
 
 #include "php_v8js_macros.h"
 #include "v8js_array_access.h"
+#include "v8js_dtrace.h"
 #include "v8js_exceptions.h"
 #include "v8js_generator_export.h"
+#include "v8js_iterator_export.h"
+#include "v8js_metrics.h"
 #include "v8js_object_export.h"
+#include "v8js_profiler.h"
+#include "v8js_tracing.h"
 #include "v8js_v8object_class.h"
 
 extern "C" {
@@ -30,6 +35,9 @@ extern "C" {
 #include "zend_closures.h"
 #include "zend_exceptions.h"
 #include "zend_generators.h"
+#if PHP_VERSION_ID >= 80100
+#include "zend_enum.h"
+#endif
 }
 
 static void v8js_weak_object_callback(const v8::WeakCallbackInfo<zend_object> &data);
@@ -50,6 +58,12 @@ static void v8js_call_php_func(zend_object *object, zend_function *method_ptr, c
 
 	v8js_ctx *ctx = (v8js_ctx *) isolate->GetData(0);
 
+	V8JS_PROBE2(callback__entry, ZSTR_VAL(object->ce->name), ZSTR_VAL(method_ptr->common.function_name));
+	uint64_t probe_start = V8JS_PROBE_TIMESTAMP(callback__return);
+	uint64_t profile_start = v8js_profile_start();
+	V8JS_METRIC_LOCAL_ADD(callbacks, 1);
+	v8js_trace_scope trace_scope("callback", "class", ZSTR_VAL(object->ce->name), "method", ZSTR_VAL(method_ptr->common.function_name));
+
 	/* Set parameter limits */
 	min_num_args = method_ptr->common.required_num_args;
 	max_num_args = method_ptr->common.num_args;
@@ -182,6 +196,9 @@ failure:
 		return_value = zval_to_v8js(&retval, isolate);
 	}
 
+	V8JS_PROBE3(callback__return, ZSTR_VAL(object->ce->name), Z_STRVAL(fname), v8js_probe_now() - probe_start);
+	v8js_profile_record(ctx, profile_start, object->ce, "::", Z_STRVAL(fname), Z_STRLEN(fname));
+
 	zval_ptr_dtor(&retval);
 	zval_ptr_dtor(&fname);
 
@@ -720,6 +737,9 @@ v8::Local<v8::Value> v8js_named_property_callback(v8::Local<v8::Name> property_n
 			name++; name_len--;
 		}
 
+		/* Query and delete are not worth profiling, only get and set */
+		uint64_t profile_start = (callback_type == V8JS_PROP_GETTER || callback_type == V8JS_PROP_SETTER) ? v8js_profile_start() : 0;
+
 		zval zname;
 		ZVAL_STRINGL(&zname, name, name_len);
 
@@ -756,6 +776,12 @@ v8::Local<v8::Value> v8js_named_property_callback(v8::Local<v8::Name> property_n
 			}
 
 		} else if (callback_type == V8JS_PROP_SETTER) {
+#if PHP_VERSION_ID >= 80100
+			if (ce->ce_flags & ZEND_ACC_ENUM) {
+				/* Enum cases are immutable, like a frozen object in strict mode */
+				ret_value = V8JS_THROW(isolate, TypeError, "Cannot modify enum case", sizeof("Cannot modify enum case") - 1);
+			} else
+#endif
 			if (v8js_to_zval(set_value, &php_value, ctx->flags, isolate) != SUCCESS) {
 				ret_value = v8::Local<v8::Value>();
 			}
@@ -795,6 +821,11 @@ v8::Local<v8::Value> v8js_named_property_callback(v8::Local<v8::Name> property_n
 			} else {
 				zend_property_info *property_info = zend_get_property_info(ce, Z_STR(zname), 1);
 
+#if PHP_VERSION_ID >= 80100
+				if (ce->ce_flags & ZEND_ACC_ENUM) {
+					ret_value = V8JS_FALSE();
+				} else
+#endif
 				if(!property_info ||
 				   (property_info != ZEND_WRONG_PROPERTY_INFO &&
 					property_info->flags & ZEND_ACC_PUBLIC)) {
@@ -810,6 +841,7 @@ v8::Local<v8::Value> v8js_named_property_callback(v8::Local<v8::Name> property_n
 			ret_value = v8::Local<v8::Value>();
 		}
 
+		v8js_profile_record(ctx, profile_start, ce, "->", name, name_len, callback_type == V8JS_PROP_SETTER ? "=" : "");
 		zval_ptr_dtor(&zname);
 	}
 
@@ -870,6 +902,14 @@ static v8::MaybeLocal<v8::Object> v8js_wrap_object(v8::Isolate *isolate, zend_cl
 	v8::Local<v8::FunctionTemplate> new_tpl;
 	v8js_function_tmpl_t *persist_tpl_;
 
+	/* Object exported before and its wrapper not yet garbage collected
+	 * (the weak callback erases the entry), hand out the same wrapper */
+	std::map<zend_object *, v8js_persistent_obj_t>::iterator weak_it = ctx->weak_objects.find(Z_OBJ_P(value));
+
+	if (weak_it != ctx->weak_objects.end() && !weak_it->second.IsEmpty()) {
+		return v8::Local<v8::Object>::New(isolate, weak_it->second);
+	}
+
 	try {
 		new_tpl = v8::Local<v8::FunctionTemplate>::New
 			(isolate, ctx->template_cache.at(ce->name));
@@ -935,6 +975,16 @@ static v8::MaybeLocal<v8::Object> v8js_wrap_object(v8::Isolate *isolate, zend_cl
 			}
 
 
+			v8::PropertyHandlerFlags handler_flags = v8::PropertyHandlerFlags::kNone;
+
+			/* Make Traversable objects iterable by for...of & spread, driven
+			 * by the class' get_iterator handler.  Symbol lookups must pass the
+			 * interceptors to find the Symbol.iterator template property. */
+			if (ce != zend_ce_generator && ce->get_iterator && instanceof_function(ce, zend_ce_traversable)) {
+				v8js_iterator_export_register(isolate, inst_tpl);
+				handler_flags = v8::PropertyHandlerFlags::kOnlyInterceptStrings;
+			}
+
 			// Finish setup of new_tpl
 			inst_tpl->SetHandler(v8::NamedPropertyHandlerConfiguration
 				(getter, /* getter */
@@ -942,7 +992,8 @@ static v8::MaybeLocal<v8::Object> v8js_wrap_object(v8::Isolate *isolate, zend_cl
 				 v8js_named_property_query, /* query */
 				 v8js_named_property_deleter, /* deleter */
 				 enumerator, /* enumerator */
-				 V8JS_NULL /* data */
+				 V8JS_NULL, /* data */
+				 handler_flags /* flags */
 				 ));
 			// add __invoke() handler
 			zend_string *invoke_str = zend_string_init
@@ -1058,6 +1109,40 @@ static v8::Local<v8::Object> v8js_wrap_array_to_object(v8::Isolate *isolate, zva
 /* }}} */
 
 
+#if PHP_VERSION_ID >= 80100
+/* Enum cases are singletons, hence each of them is wrapped once per context
+ * and the wrapper is kept alive, so identity holds across conversions.  It's
+ * the regular object wrapper, i.e. enum methods stay callable; V8 can't freeze
+ * objects with interceptors, writes are refused by the setter instead. */
+static v8::Local<v8::Value> v8js_enum_case_to_js(v8::Isolate *isolate, zend_object *object) /* {{{ */
+{
+	v8js_ctx *ctx = (v8js_ctx *) isolate->GetData(0);
+
+	if (object->ce->enum_backing_type != IS_UNDEF && V8JSG(enum_as_value)) {
+		return zval_to_v8js(zend_enum_fetch_case_value(object), isolate);
+	}
+
+	std::unordered_map<zend_object *, v8js_persistent_obj_t>::iterator it = ctx->enum_cases.find(object);
+
+	if (it != ctx->enum_cases.end()) {
+		return v8::Local<v8::Object>::New(isolate, it->second);
+	}
+
+	zval value;
+	ZVAL_OBJ(&value, object);
+
+	v8::Local<v8::Object> wrapped;
+
+	if (!v8js_wrap_object(isolate, object->ce, &value).ToLocal(&wrapped)) {
+		return V8JS_UNDEFINED;
+	}
+
+	ctx->enum_cases[object].Reset(isolate, wrapped);
+	return wrapped;
+}
+/* }}} */
+#endif
+
 v8::Local<v8::Value> v8js_hash_to_jsobj(zval *value, v8::Isolate *isolate) /* {{{ */
 {
 	HashTable *myht;
@@ -1066,6 +1151,12 @@ v8::Local<v8::Value> v8js_hash_to_jsobj(zval *value, v8::Isolate *isolate) /* {{
 	if (Z_TYPE_P(value) == IS_ARRAY) {
 		myht = HASH_OF(value);
 	} else {
+#if PHP_VERSION_ID >= 80100
+		/* before Z_OBJPROP_P, which would build the property table */
+		if (Z_OBJCE_P(value)->ce_flags & ZEND_ACC_ENUM) {
+			return v8js_enum_case_to_js(isolate, Z_OBJ_P(value));
+		}
+#endif
 		myht = Z_OBJPROP_P(value);
 		ce = Z_OBJCE_P(value);
 	}
@@ -0,0 +1,217 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_v8js_macros.h"
+#include "v8js_metrics.h"
+#include "v8js_prewarm.h"
+
+extern "C" {
+#include "php_ini.h"
+#include "main/php_streams.h"
+}
+
+static zend_string *v8js_prewarm_read_file(const char *path) /* {{{ */
+{
+	php_stream *stream = php_stream_open_wrapper(path, "rb", REPORT_ERRORS, NULL);
+	zend_string *contents;
+
+	if (!stream) {
+		return NULL;
+	}
+
+	contents = php_stream_copy_to_mem(stream, PHP_STREAM_COPY_ALL, 1);
+	php_stream_close(stream);
+	return contents;
+}
+/* }}} */
+
+/* Snapshot must outlive the isolates created from it, hence it's kept
+ * (persistently) for the rest of the process' life time */
+static v8::StartupData *v8js_prewarm_snapshot() /* {{{ */
+{
+	const char *path = INI_STR("v8js.prewarm_snapshot");
+
+	if (!path || !path[0]) {
+		return NULL;
+	}
+
+	if (!V8JSG(prewarm_snapshot_data)) {
+		zend_string *blob = v8js_prewarm_read_file(path);
+
+		if (!blob || ZSTR_LEN(blob) > std::numeric_limits<int>::max()) {
+			if (blob) {
+				zend_string_release(blob);
+			}
+			return NULL;
+		}
+
+		V8JSG(prewarm_snapshot_data) = zend_string_dup(blob, 1);
+		zend_string_release(blob);
+
+		V8JSG(prewarm_snapshot).data = ZSTR_VAL(V8JSG(prewarm_snapshot_data));
+		V8JSG(prewarm_snapshot).raw_size = static_cast<int>(ZSTR_LEN(V8JSG(prewarm_snapshot_data)));
+	}
+
+	return &V8JSG(prewarm_snapshot);
+}
+/* }}} */
+
+static void v8js_prewarm_dispose(v8js_prewarmed *p) /* {{{ */
+{
+	p->context.Reset();
+	p->isolate->Dispose();
+	delete p->allocator;
+	delete p;
+}
+/* }}} */
+
+static bool v8js_prewarm_bootstrap(v8js_prewarmed *p, zend_string *script) /* {{{ */
+{
+	v8::Isolate *isolate = p->isolate;
+	v8::Locker locker(isolate);
+	v8::Isolate::Scope isolate_scope(isolate);
+	v8::HandleScope handle_scope(isolate);
+
+	/* Builtins (print, require, console, ...) need a V8Js instance, they
+	 * are installed once the context is adopted.  The bootstrap script,
+	 * like snapshot code, hence must not use them. */
+	v8::Local<v8::Context> context = v8::Context::New(isolate);
+	p->context.Reset(isolate, context);
+
+	if (!script) {
+		return true;
+	}
+
+	v8::Context::Scope context_scope(context);
+	v8::TryCatch try_catch(isolate);
+	v8::ScriptOrigin origin(isolate, V8JS_STR(INI_STR("v8js.prewarm_script")));
+	v8::Local<v8::Script> compiled;
+
+	if (!v8::Script::Compile(context, V8JS_ZSTR(script), &origin).ToLocal(&compiled) ||
+		compiled->Run(context).IsEmpty()) {
+		v8::String::Utf8Value message(isolate, try_catch.Exception());
+		php_error_docref(NULL, E_WARNING, "V8Js prewarm script failed: %s", ToCString(message));
+		return false;
+	}
+
+	return true;
+}
+/* }}} */
+
+static v8js_prewarmed *v8js_prewarm_create(zend_string *script) /* {{{ */
+{
+	v8::Isolate::CreateParams create_params;
+	v8js_prewarmed *p = new v8js_prewarmed();
+
+	p->allocator = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+	create_params.array_buffer_allocator = p->allocator;
+	create_params.snapshot_blob = v8js_prewarm_snapshot();
+
+	p->isolate = v8::Isolate::New(create_params);
+	V8JS_METRIC_INC(isolate_creations);
+
+	if (!v8js_prewarm_bootstrap(p, script)) {
+		v8js_prewarm_dispose(p);
+		return NULL;
+	}
+
+	return p;
+}
+/* }}} */
+
+size_t v8js_prewarm_fill(zend_long count) /* {{{ */
+{
+#ifdef USE_INTERNAL_ALLOCATOR
+	/* Pooled isolates bring their own allocator, which can't be passed
+	 * to V8Js instances in this configuration */
+	return 0;
+#else
+	zend_string *script = NULL;
+	const char *script_path = INI_STR("v8js.prewarm_script");
+
+	if (count <= 0 || V8JSG(prewarm_pool).size() >= static_cast<size_t>(count)) {
+		return V8JSG(prewarm_pool).size();
+	}
+
+	v8js_v8_init();
+
+	if (script_path && script_path[0]) {
+		if (!(script = v8js_prewarm_read_file(script_path))) {
+			return V8JSG(prewarm_pool).size();
+		}
+
+		if (ZSTR_LEN(script) > std::numeric_limits<int>::max()) {
+			zend_string_release(script);
+			return V8JSG(prewarm_pool).size();
+		}
+	}
+
+	while (V8JSG(prewarm_pool).size() < static_cast<size_t>(count)) {
+		v8js_prewarmed *p = v8js_prewarm_create(script);
+
+		if (!p) {
+			break;
+		}
+
+		V8JSG(prewarm_pool).push_back(p);
+	}
+
+	if (script) {
+		zend_string_release(script);
+	}
+
+	return V8JSG(prewarm_pool).size();
+#endif
+}
+/* }}} */
+
+v8js_prewarmed *v8js_prewarm_acquire() /* {{{ */
+{
+	if (V8JSG(prewarm_pool).empty()) {
+		return NULL;
+	}
+
+	v8js_prewarmed *p = V8JSG(prewarm_pool).back();
+	V8JSG(prewarm_pool).pop_back();
+	return p;
+}
+/* }}} */
+
+void v8js_prewarm_shutdown() /* {{{ */
+{
+	for (std::vector<v8js_prewarmed *>::iterator it = V8JSG(prewarm_pool).begin();
+		 it != V8JSG(prewarm_pool).end(); ++it) {
+		v8js_prewarm_dispose(*it);
+	}
+
+	V8JSG(prewarm_pool).clear();
+
+	if (V8JSG(prewarm_snapshot_data)) {
+		zend_string_release(V8JSG(prewarm_snapshot_data));
+		V8JSG(prewarm_snapshot_data) = NULL;
+	}
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
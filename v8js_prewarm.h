@@ -0,0 +1,43 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_PREWARM_H
+#define V8JS_PREWARM_H
+
+/* Isolate & context created (and bootstrapped) ahead of time, adopted by
+ * the next V8Js::__construct() call without snapshot argument */
+struct v8js_prewarmed {
+	v8::Isolate *isolate;
+	v8::ArrayBuffer::Allocator *allocator;
+	v8::Persistent<v8::Context> context;
+};
+
+/* Create instances until the pool holds count ones, returns pool size */
+size_t v8js_prewarm_fill(zend_long count);
+
+/* Take an instance from the pool (caller owns it), NULL if empty */
+v8js_prewarmed *v8js_prewarm_acquire();
+
+/* Dispose all pooled instances */
+void v8js_prewarm_shutdown();
+
+#endif /* V8JS_PREWARM_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
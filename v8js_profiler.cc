@@ -0,0 +1,108 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include "php_v8js_macros.h"
+#include "v8js_profiler.h"
+
+void v8js_profile_record(v8js_ctx *c, uint64_t start, zend_class_entry *ce, const char *sep, const char *name, size_t name_len, const char *suffix) /* {{{ */
+{
+	if (!start) {
+		return;
+	}
+
+	/* Not v8js_profile_start(), which returns 0 if profiling was switched
+	 * off during the callback */
+	uint64_t end = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	uint64_t duration = end > start ? end - start : 0;
+
+	std::string key(ZSTR_VAL(ce->name), ZSTR_LEN(ce->name));
+	key.append(sep);
+	key.append(name, name_len);
+	key.append(suffix);
+
+	v8js_callback_stats &stats = c->callback_profile[key];
+	stats.calls ++;
+	stats.total_ns += duration;
+	stats.max_ns = std::max(stats.max_ns, duration);
+
+	/* Bucket i counts calls shorter than 2^i microseconds */
+	uint64_t us = duration / 1000;
+	int bucket = 0;
+
+	while (us && bucket < V8JS_PROFILE_BUCKETS - 1) {
+		us >>= 1;
+		bucket ++;
+	}
+
+	stats.histogram[bucket] ++;
+}
+/* }}} */
+
+void v8js_profile_to_array(v8js_ctx *c, zend_long limit, zval *return_value) /* {{{ */
+{
+	typedef std::pair<const std::string, v8js_callback_stats> entry_t;
+	std::vector<const entry_t *> entries;
+
+	for (std::unordered_map<std::string, v8js_callback_stats>::const_iterator it = c->callback_profile.begin();
+		 it != c->callback_profile.end(); ++it) {
+		entries.push_back(&*it);
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const entry_t *a, const entry_t *b) {
+		return a->second.total_ns > b->second.total_ns;
+	});
+
+	if (limit > 0 && entries.size() > static_cast<size_t>(limit)) {
+		entries.resize(limit);
+	}
+
+	array_init_size(return_value, static_cast<uint32_t>(entries.size()));
+
+	for (std::vector<const entry_t *>::iterator it = entries.begin(); it != entries.end(); ++it) {
+		const v8js_callback_stats &stats = (*it)->second;
+		zval entry, histogram;
+
+		array_init_size(&histogram, V8JS_PROFILE_BUCKETS);
+		for (int i = 0; i < V8JS_PROFILE_BUCKETS; i ++) {
+			if (stats.histogram[i]) {
+				add_index_long(&histogram, ZEND_LONG(1) << i, static_cast<zend_long>(stats.histogram[i]));
+			}
+		}
+
+		array_init_size(&entry, 6);
+		add_assoc_stringl(&entry, "name", const_cast<char *>((*it)->first.data()), (*it)->first.size());
+		add_assoc_long(&entry, "calls", static_cast<zend_long>(stats.calls));
+		add_assoc_double(&entry, "total_us", stats.total_ns / 1000.0);
+		add_assoc_double(&entry, "avg_us", stats.total_ns / 1000.0 / stats.calls);
+		add_assoc_double(&entry, "max_us", stats.max_ns / 1000.0);
+		add_assoc_zval(&entry, "histogram", &histogram);
+		add_next_index_zval(return_value, &entry);
+	}
+}
+/* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -0,0 +1,44 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_PROFILER_H
+#define V8JS_PROFILER_H
+
+/* Start timestamp (in ns) of a JS->PHP callback, 0 if profiling is off */
+static inline uint64_t v8js_profile_start() /* {{{ */
+{
+	if (EXPECTED(!V8JSG(profile_callbacks))) {
+		return 0;
+	}
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+/* }}} */
+
+/* Account callback, that was started at start, as "<class><sep><name><suffix>" */
+void v8js_profile_record(v8js_ctx *c, uint64_t start, zend_class_entry *ce, const char *sep, const char *name, size_t name_len, const char *suffix = "");
+
+/* Export top limit entries (by total time) to a PHP array */
+void v8js_profile_to_array(v8js_ctx *c, zend_long limit, zval *return_value);
+
+#endif /* V8JS_PROFILER_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
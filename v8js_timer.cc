@@ -21,10 +21,12 @@
 
 #include "php_v8js_macros.h"
 #include "v8js_v8.h"
+#include "v8js_dtrace.h"
 #include "v8js_exceptions.h"
 #include "v8js_timer.h"
 
 extern "C" {
+#include "php_ini.h"
 #include "ext/date/php_date.h"
 #include "ext/standard/php_string.h"
 #include "zend_interfaces.h"
@@ -33,6 +35,85 @@ extern "C" {
 #include "zend_exceptions.h"
 }
 
+/* Number of JS stack frames written to the slow log */
+#define V8JS_SLOWLOG_FRAMES 32
+
+static void v8js_slowlog_write(const std::string &entry) /* {{{ */
+{
+	const char *path = INI_STR("v8js.slowlog");
+
+	if (path && path[0]) {
+		FILE *fp = VCWD_FOPEN(path, "a");
+
+		if (fp) {
+			fwrite(entry.data(), 1, entry.size(), fp);
+			fclose(fp);
+			return;
+		}
+	}
+
+	/* error log adds its own timestamp & trailing newline */
+	std::string message(entry, entry.find(']') + 2);
+	message.erase(message.size() - 1);
+	php_log_err(const_cast<char *>(message.c_str()));
+}
+/* }}} */
+
+/* Runs on the executing thread, hence can safely capture the JS stack */
+static void v8js_slowlog_interrupt_handler(v8::Isolate *isolate, void *data) { /* {{{ */
+	zend_v8js_globals *globals = static_cast<zend_v8js_globals *>(data);
+	std::string identifier;
+	long elapsed = -1;
+
+	globals->timer_mutex.lock();
+	for (std::deque< v8js_timer_ctx* >::iterator it = globals->timer_stack.begin();
+		 it != globals->timer_stack.end(); it ++) {
+		v8js_timer_ctx *timer_ctx = *it;
+
+		if (timer_ctx->ctx->isolate == isolate && timer_ctx->slowlog_state == V8JS_SLOWLOG_REQUESTED) {
+			timer_ctx->slowlog_state = V8JS_SLOWLOG_DONE;
+
+			/* report the outermost slow execution only */
+			identifier = timer_ctx->identifier ? timer_ctx->identifier : "";
+			elapsed = static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::high_resolution_clock::now() - timer_ctx->start_point).count());
+		}
+	}
+	globals->timer_mutex.unlock();
+
+	if (elapsed < 0) {
+		return;
+	}
+
+	v8::HandleScope handle_scope(isolate);
+	v8::Local<v8::StackTrace> stack = v8::StackTrace::CurrentStackTrace(isolate, V8JS_SLOWLOG_FRAMES, v8::StackTrace::kOverview);
+
+	zend_string *date = php_format_date("d-M-Y H:i:s", sizeof("d-M-Y H:i:s") - 1, time(NULL), 1);
+	char *header;
+	spprintf(&header, 0, "[%s] V8Js script '%s' executing for %ld ms\n", ZSTR_VAL(date), identifier.c_str(), elapsed);
+	zend_string_release(date);
+
+	std::string entry(header);
+	efree(header);
+
+	for (int i = 0; i < stack->GetFrameCount(); i ++) {
+		v8::Local<v8::StackFrame> frame = stack->GetFrame(isolate, i);
+		v8::String::Utf8Value function_name(isolate, frame->GetFunctionName());
+		v8::String::Utf8Value script_name(isolate, frame->GetScriptName());
+		char *line;
+
+		spprintf(&line, 0, "    at %s (%s:%d:%d)\n",
+			function_name.length() ? ToCString(function_name) : "<anonymous>",
+			script_name.length() ? ToCString(script_name) : "<unknown>",
+			frame->GetLineNumber(), frame->GetColumn());
+		entry.append(line);
+		efree(line);
+	}
+
+	v8js_slowlog_write(entry);
+}
+/* }}} */
+
 static void v8js_timer_interrupt_handler(v8::Isolate *isolate, void *data) { /* {{{ */
 	zend_v8js_globals *globals = static_cast<zend_v8js_globals *>(data);
 
@@ -66,6 +147,7 @@ static void v8js_timer_interrupt_handler(v8::Isolate *isolate, void *data) { /*
 
 			if (timer_ctx->memory_limit > 0 && hs.used_heap_size() > timer_ctx->memory_limit) {
 				if (has_sent_notification) {
+					V8JS_PROBE3(watchdog__terminate, c, V8JS_PROBE_REASON_MEMORY_LIMIT, timer_ctx->memory_limit);
 					timer_ctx->killed = true;
 					c->isolate->TerminateExecution();
 					c->memory_limit_hit = true;
@@ -97,6 +179,7 @@ void v8js_timer_thread(zend_v8js_globals *globals) /* {{{ */
 				 * but wait for caller to pop this timer context. */
 			}
 			else if(timer_ctx->time_limit > 0 && now > timer_ctx->time_point) {
+				V8JS_PROBE3(watchdog__terminate, c, V8JS_PROBE_REASON_TIME_LIMIT, timer_ctx->time_limit);
 				timer_ctx->killed = true;
 				c->isolate->TerminateExecution();
 				c->time_limit_hit = true;
@@ -109,6 +192,16 @@ void v8js_timer_thread(zend_v8js_globals *globals) /* {{{ */
 				 * and cannot aquire it as v8 is executing the script ... */
 				c->isolate->RequestInterrupt(v8js_timer_interrupt_handler, static_cast<void *>(globals));
 			}
+
+			/* Slow log, checked for all nesting levels as the outer ones
+			 * may have passed the threshold first */
+			for (std::deque< v8js_timer_ctx* >::iterator it = globals->timer_stack.begin();
+				 it != globals->timer_stack.end(); it ++) {
+				if ((*it)->slowlog_state == V8JS_SLOWLOG_ARMED && !(*it)->killed && now > (*it)->slowlog_point) {
+					(*it)->slowlog_state = V8JS_SLOWLOG_REQUESTED;
+					(*it)->ctx->isolate->RequestInterrupt(v8js_slowlog_interrupt_handler, static_cast<void *>(globals));
+				}
+			}
 		}
 		globals->timer_mutex.unlock();
 
@@ -124,7 +217,7 @@ void v8js_timer_thread(zend_v8js_globals *globals) /* {{{ */
 /* }}} */
 
 
-void v8js_timer_push(long time_limit, size_t memory_limit, v8js_ctx *c) /* {{{ */
+void v8js_timer_push(long time_limit, size_t memory_limit, const char *identifier, v8js_ctx *c) /* {{{ */
 {
 	V8JSG(timer_mutex).lock();
 
@@ -141,6 +234,11 @@ void v8js_timer_push(long time_limit, size_t memory_limit, v8js_ctx *c) /* {{{ *
 	timer_ctx->time_point = from + duration;
 	timer_ctx->ctx = c;
 	timer_ctx->killed = false;
+
+	timer_ctx->identifier = identifier;
+	timer_ctx->start_point = from;
+	timer_ctx->slowlog_point = from + std::chrono::milliseconds(V8JSG(slowlog_threshold));
+	timer_ctx->slowlog_state = V8JSG(slowlog_threshold) > 0 ? V8JS_SLOWLOG_ARMED : V8JS_SLOWLOG_NONE;
 	V8JSG(timer_stack).push_front(timer_ctx);
 
 	V8JSG(timer_mutex).unlock();
@@ -22,10 +22,21 @@ struct v8js_timer_ctx
   std::chrono::time_point<std::chrono::high_resolution_clock> time_point;
   v8js_ctx *ctx;
   bool killed;
+
+  // Slow log, see v8js.slowlog_threshold_ms
+  const char *identifier;
+  std::chrono::time_point<std::chrono::high_resolution_clock> start_point;
+  std::chrono::time_point<std::chrono::high_resolution_clock> slowlog_point;
+  int slowlog_state;
 };
 
+#define V8JS_SLOWLOG_NONE		0	/* no threshold set */
+#define V8JS_SLOWLOG_ARMED		1
+#define V8JS_SLOWLOG_REQUESTED	2	/* interrupt requested, stack not captured yet */
+#define V8JS_SLOWLOG_DONE		3
+
 void v8js_timer_thread(zend_v8js_globals *globals);
-void v8js_timer_push(long time_limit, size_t memory_limit, v8js_ctx *c);
+void v8js_timer_push(long time_limit, size_t memory_limit, const char *identifier, v8js_ctx *c);
 
 #endif /* V8JS_TIMER_H */
 
@@ -0,0 +1,222 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <fstream>
+
+#include "php_v8js_macros.h"
+#include "v8js_exceptions.h"
+#include "v8js_tracing.h"
+
+extern "C" {
+#include "zend_exceptions.h"
+}
+
+#include <libplatform/libplatform.h>
+
+/* see trace_event_common.h of V8, which isn't part of the public API */
+#define V8JS_TRACE_EVENT_PHASE_COMPLETE		('X')
+#define V8JS_TRACE_VALUE_TYPE_COPY_STRING	(static_cast<uint8_t>(7))
+
+static const uint8_t v8js_tracing_disabled = 0;
+const uint8_t *v8js_tracing_enabled = &v8js_tracing_disabled;
+
+#ifdef V8JS_HAVE_TRACING
+
+using v8::platform::tracing::TraceBuffer;
+using v8::platform::tracing::TraceConfig;
+using v8::platform::tracing::TraceObject;
+using v8::platform::tracing::TraceWriter;
+using v8::platform::tracing::TracingController;
+
+/* The trace buffer (and hence its writer) is handed to the controller once,
+ * this writer forwards to a JSON writer on the file of the current session. */
+class v8js_trace_writer : public TraceWriter {
+public:
+	void AppendTraceEvent(TraceObject *trace_event) override {
+		if (json_writer) {
+			json_writer->AppendTraceEvent(trace_event);
+		}
+	}
+
+	void Flush() override {
+		if (json_writer) {
+			json_writer->Flush();
+		}
+	}
+
+	bool Open(const char *path) {
+		stream.open(path, std::ios::out | std::ios::trunc);
+
+		if (!stream.is_open()) {
+			return false;
+		}
+
+		json_writer.reset(TraceWriter::CreateJSONTraceWriter(stream));
+		return true;
+	}
+
+	void Close() {
+		json_writer.reset(); /* writes the closing brackets */
+		stream.close();
+	}
+
+private:
+	std::ofstream stream;
+	std::unique_ptr<TraceWriter> json_writer;
+};
+
+static std::mutex v8js_tracing_lock;
+static TracingController *v8js_tracing_controller = NULL;
+static v8js_trace_writer *v8js_tracing_writer = NULL;
+static bool v8js_tracing_active = false;
+
+std::unique_ptr<v8::TracingController> v8js_tracing_create_controller() /* {{{ */
+{
+	TracingController *controller = new TracingController();
+
+	v8js_tracing_writer = new v8js_trace_writer();
+	controller->Initialize(TraceBuffer::CreateTraceBufferRingBuffer(TraceBuffer::kRingBufferChunks, v8js_tracing_writer));
+
+	v8js_tracing_controller = controller;
+	v8js_tracing_enabled = controller->GetCategoryGroupEnabled("v8js");
+
+	return std::unique_ptr<v8::TracingController>(controller);
+}
+/* }}} */
+
+bool v8js_tracing_start(const char *path, const char *categories) /* {{{ */
+{
+	std::lock_guard<std::mutex> lock(v8js_tracing_lock);
+
+	if (!v8js_tracing_controller) {
+		zend_throw_exception(php_ce_v8js_exception, "V8 platform not initialized", 0);
+		return false;
+	}
+
+	if (v8js_tracing_active) {
+		zend_throw_exception(php_ce_v8js_exception, "Tracing already started", 0);
+		return false;
+	}
+
+	if (!v8js_tracing_writer->Open(path)) {
+		zend_throw_exception_ex(php_ce_v8js_exception, 0, "Failed to open trace file '%s'", path);
+		return false;
+	}
+
+	TraceConfig *config = new TraceConfig();
+	const char *p = categories;
+
+	while (p && *p) {
+		const char *end = strchr(p, ',');
+		size_t len = end ? static_cast<size_t>(end - p) : strlen(p);
+		std::string category(p, len);
+
+		category.erase(0, category.find_first_not_of(" \t"));
+		category.erase(category.find_last_not_of(" \t") + 1);
+
+		if (!category.empty()) {
+			config->AddIncludedCategory(category.c_str());
+		}
+
+		p = end ? end + 1 : NULL;
+	}
+
+	v8js_tracing_controller->StartTracing(config);
+	v8js_tracing_active = true;
+	return true;
+}
+/* }}} */
+
+bool v8js_tracing_stop() /* {{{ */
+{
+	std::lock_guard<std::mutex> lock(v8js_tracing_lock);
+
+	if (!v8js_tracing_active) {
+		return false;
+	}
+
+	/* Flushes the buffered events to the writer */
+	v8js_tracing_controller->StopTracing();
+	v8js_tracing_writer->Close();
+	v8js_tracing_active = false;
+	return true;
+}
+/* }}} */
+
+uint64_t v8js_tracing_begin(const char *name, const char *arg1_name, const char *arg1, const char *arg2_name, const char *arg2) /* {{{ */
+{
+	const char *arg_names[2] = { arg1_name, arg2_name };
+	const uint8_t arg_types[2] = { V8JS_TRACE_VALUE_TYPE_COPY_STRING, V8JS_TRACE_VALUE_TYPE_COPY_STRING };
+	uint64_t arg_values[2] = {
+		reinterpret_cast<uintptr_t>(arg1 ? arg1 : ""),
+		reinterpret_cast<uintptr_t>(arg2 ? arg2 : ""),
+	};
+	int32_t num_args = arg2_name ? 2 : arg1_name ? 1 : 0;
+
+	return v8js_tracing_controller->AddTraceEvent(V8JS_TRACE_EVENT_PHASE_COMPLETE, v8js_tracing_enabled,
+		name, nullptr, 0, 0, num_args, arg_names, arg_types, arg_values, nullptr, 0);
+}
+/* }}} */
+
+void v8js_tracing_end(const char *name, uint64_t handle) /* {{{ */
+{
+	v8js_tracing_controller->UpdateTraceEventDuration(v8js_tracing_enabled, name, handle);
+}
+/* }}} */
+
+#else
+
+std::unique_ptr<v8::TracingController> v8js_tracing_create_controller() /* {{{ */
+{
+	return nullptr;
+}
+/* }}} */
+
+bool v8js_tracing_start(const char *path, const char *categories) /* {{{ */
+{
+	zend_throw_exception(php_ce_v8js_exception, "Tracing is not supported by this V8 build", 0);
+	return false;
+}
+/* }}} */
+
+bool v8js_tracing_stop() /* {{{ */
+{
+	return false;
+}
+/* }}} */
+
+uint64_t v8js_tracing_begin(const char *name, const char *arg1_name, const char *arg1, const char *arg2_name, const char *arg2) /* {{{ */
+{
+	return 0;
+}
+/* }}} */
+
+void v8js_tracing_end(const char *name, uint64_t handle) /* {{{ */
+{
+}
+/* }}} */
+
+#endif /* V8JS_HAVE_TRACING */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
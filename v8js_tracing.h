@@ -0,0 +1,72 @@
+/*
+  +----------------------------------------------------------------------+
+  | PHP Version 7                                                        |
+  +----------------------------------------------------------------------+
+  | Copyright (c) 1997-2017 The PHP Group                                |
+  +----------------------------------------------------------------------+
+  | http://www.opensource.org/licenses/mit-license.php  MIT License      |
+  +----------------------------------------------------------------------+
+  | Author: Stefan Siegl <stesie@php.net>                                |
+  +----------------------------------------------------------------------+
+*/
+
+#ifndef V8JS_TRACING_H
+#define V8JS_TRACING_H
+
+/* Chrome trace-event export via the platform's TracingController.
+ *
+ * V8 builds with Perfetto use a different tracing backend, which we don't
+ * support (yet); tracing is just unavailable there. */
+#ifndef V8_USE_PERFETTO
+#define V8JS_HAVE_TRACING 1
+#endif
+
+/* Enabled flag of our own "v8js" category, maintained by V8 */
+extern const uint8_t *v8js_tracing_enabled;
+
+/* Create the controller to pass to NewDefaultPlatform() */
+std::unique_ptr<v8::TracingController> v8js_tracing_create_controller();
+
+/* Start writing categories (comma separated) to path; throws on failure */
+bool v8js_tracing_start(const char *path, const char *categories);
+
+/* Stop tracing and finish the trace file, false if not tracing */
+bool v8js_tracing_stop();
+
+uint64_t v8js_tracing_begin(const char *name, const char *arg1_name, const char *arg1, const char *arg2_name, const char *arg2);
+void v8js_tracing_end(const char *name, uint64_t handle);
+
+/* Complete ("X") event of category v8js lasting as long as the scope,
+ * pass name = NULL to skip the event */
+class v8js_trace_scope {
+public:
+	v8js_trace_scope(const char *name, const char *arg1_name = NULL, const char *arg1 = NULL,
+					 const char *arg2_name = NULL, const char *arg2 = NULL) : name(NULL), handle(0) {
+		if (UNEXPECTED(*v8js_tracing_enabled) && name) {
+			this->name = name;
+			handle = v8js_tracing_begin(name, arg1_name, arg1, arg2_name, arg2);
+		}
+	}
+
+	~v8js_trace_scope() {
+		if (UNEXPECTED(this->name != NULL)) {
+			v8js_tracing_end(name, handle);
+		}
+	}
+
+private:
+	const char *name;
+	uint64_t handle;
+};
+
+#endif /* V8JS_TRACING_H */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * indent-tabs-mode: t
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
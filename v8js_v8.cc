@@ -18,8 +18,12 @@
 
 #include "php_v8js_macros.h"
 #include "v8js_v8.h"
+#include "v8js_async.h"
+#include "v8js_dtrace.h"
 #include "v8js_timer.h"
+#include "v8js_tracing.h"
 #include "v8js_exceptions.h"
+#include "v8js_metrics.h"
 
 extern "C" {
 #include "ext/date/php_date.h"
@@ -68,7 +72,9 @@ void v8js_v8_init() /* {{{ */
 #endif
 #endif
 
-	v8js_process_globals.v8_platform = v8::platform::NewDefaultPlatform();
+	v8js_process_globals.v8_platform = v8::platform::NewDefaultPlatform(0,
+		v8::platform::IdleTaskSupport::kDisabled, v8::platform::InProcessStackDumping::kDisabled,
+		v8js_tracing_create_controller());
 	v8::V8::InitializePlatform(v8js_process_globals.v8_platform.get());
 
 	/* Set V8 command line flags (must be done before V8::Initialize()!) */
@@ -115,7 +121,7 @@ void v8js_v8_init() /* {{{ */
  * heap allocated memory).
  */
 void v8js_v8_call(v8js_ctx *c, zval **return_value,
-				  long flags, long time_limit, size_t memory_limit,
+				  long flags, long time_limit, size_t memory_limit, const char *identifier,
 				  std::function< v8::MaybeLocal<v8::Value>(v8::Isolate *) >& v8_call) /* {{{ */
 {
 	char *tz = NULL;
@@ -155,7 +161,7 @@ void v8js_v8_call(v8js_ctx *c, zval **return_value,
 			}
 		}
 
-		if (time_limit > 0 || memory_limit > 0) {
+		if (time_limit > 0 || memory_limit > 0 || V8JSG(slowlog_threshold) > 0) {
 			// If timer thread is not running then start it
 			if (!V8JSG(timer_thread)) {
 				// If not, start timer thread
@@ -165,13 +171,50 @@ void v8js_v8_call(v8js_ctx *c, zval **return_value,
 
 		/* Always pass the timer to the stack so there can be follow-up changes to
 		 * the time & memory limit. */
-		v8js_timer_push(time_limit, memory_limit, c);
+		v8js_timer_push(time_limit, memory_limit, identifier, c);
 
 		/* Execute script */
+		V8JS_PROBE2(execute__entry, identifier, c->in_execution);
+		uint64_t probe_start = V8JS_PROBE_TIMESTAMP(execute__return);
+
+		std::chrono::steady_clock::time_point execution_start;
+
+		if (v8js_metrics_active) {
+			execution_start = std::chrono::steady_clock::now();
+		}
+
 		c->in_execution++;
-		v8::MaybeLocal<v8::Value> result = v8_call(c->isolate);
+		v8::MaybeLocal<v8::Value> result;
+		{
+			v8js_trace_scope trace_scope("V8Js::execute", "identifier", identifier);
+			result = v8_call(c->isolate);
+		}
 		c->in_execution--;
 
+		/* Settle async callbacks (and await the result) on the outermost call */
+		if (!c->in_execution && !try_catch.HasCaught() && !V8JSG(fatal_error_abort)
+			&& (!c->async_jobs.empty() || (flags & V8JS_FLAG_AWAIT))) {
+			v8js_async_run(c, flags, result, c->isolate);
+		} else if (!c->in_execution && !c->async_running && !V8JSG(fatal_error_abort)) {
+			/* Calls queued by a script that threw are not run either */
+			v8js_async_cancel(c, c->isolate);
+		}
+
+		if (v8js_metrics_active) {
+			V8JS_METRIC_INC(executions);
+			v8js_metrics_observe(V8JS_METRIC_HISTOGRAM_EXECUTION, std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - execution_start).count());
+		}
+
+		if (!c->in_execution) {
+			v8js_metrics_flush();
+		}
+
+		V8JS_PROBE4(execute__return, identifier, c->in_execution, v8js_probe_now() - probe_start,
+			c->time_limit_hit ? V8JS_PROBE_STATUS_TIME_LIMIT :
+			c->memory_limit_hit ? V8JS_PROBE_STATUS_MEMORY_LIMIT :
+			try_catch.HasCaught() ? V8JS_PROBE_STATUS_EXCEPTION : V8JS_PROBE_STATUS_OK);
+
 		/* Pop our context from the stack and read (possibly updated) limits
 		 * into local variables. */
 		V8JSG(timer_mutex).lock();
@@ -189,6 +232,7 @@ void v8js_v8_call(v8js_ctx *c, zval **return_value,
 
 			if (c->time_limit_hit) {
 				// Execution has been terminated due to time limit
+				V8JS_METRIC_INC(time_limit_terminations);
 				sprintf(exception_string, "Script time limit of %lu milliseconds exceeded", time_limit);
 				zend_throw_exception(php_ce_v8js_time_limit_exception, exception_string, 0);
 				zval_ptr_dtor(&zv_v8inst);
@@ -212,6 +256,7 @@ void v8js_v8_call(v8js_ctx *c, zval **return_value,
 
 			if (c->memory_limit_hit) {
 				// Execution has been terminated due to memory limit
+				V8JS_METRIC_INC(memory_limit_terminations);
 				sprintf(exception_string, "Script memory limit of %lu bytes exceeded", memory_limit);
 				zend_throw_exception(php_ce_v8js_memory_limit_exception, exception_string, 0);
 				zval_ptr_dtor(&zv_v8inst);
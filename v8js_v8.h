@@ -16,13 +16,15 @@
 
 #include <functional>
 
+#include "v8js_encoding.h"
+
 /* Helper macros */
 #define V8JS_SYM(v)			(v8::String::NewFromUtf8(isolate, v, v8::NewStringType::kInternalized, sizeof(v) - 1).ToLocalChecked())
 #define V8JS_SYML(v, l)		(v8::String::NewFromUtf8(isolate, v, v8::NewStringType::kInternalized, l).ToLocalChecked())
 #define V8JS_ZSYM(v)		(v8::String::NewFromUtf8(isolate, ZSTR_VAL(v), v8::NewStringType::kInternalized, ZSTR_LEN(v)).ToLocalChecked())
 #define V8JS_STR(v)			(v8::String::NewFromUtf8(isolate, v, v8::NewStringType::kNormal).ToLocalChecked())
-#define V8JS_STRL(v, l)		(v8::String::NewFromUtf8(isolate, v, v8::NewStringType::kNormal, l).ToLocalChecked())
-#define V8JS_ZSTR(v)		(v8::String::NewFromUtf8(isolate, ZSTR_VAL(v), v8::NewStringType::kNormal, ZSTR_LEN(v)).ToLocalChecked())
+#define V8JS_STRL(v, l)		v8js_string_new(isolate, v, l)
+#define V8JS_ZSTR(v)		v8js_string_new(isolate, ZSTR_VAL(v), ZSTR_LEN(v))
 #define V8JS_INT(v)			v8::Integer::New(isolate, v)
 #define V8JS_UINT(v)		v8::Integer::NewFromUnsigned(isolate, v)
 #define V8JS_FLOAT(v)		v8::Number::New(isolate, v)
@@ -50,11 +52,24 @@ static inline const char * ToCString(const v8::String::Utf8Value &value) /* {{{
 }
 /* }}} */
 
+/* Create JS string, pure ASCII input takes the (cheaper) one-byte path
+ * as V8 doesn't need to decode it then. */
+static inline v8::Local<v8::String> v8js_string_new(v8::Isolate *isolate, const char *str, size_t len) /* {{{ */
+{
+	if (v8js_is_ascii(reinterpret_cast<const unsigned char *>(str), len)) {
+		return v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t *>(str),
+			v8::NewStringType::kNormal, static_cast<int>(len)).ToLocalChecked();
+	}
+
+	return v8::String::NewFromUtf8(isolate, str, v8::NewStringType::kNormal, static_cast<int>(len)).ToLocalChecked();
+}
+/* }}} */
+
 
 
 void v8js_v8_init();
 void v8js_v8_call(v8js_ctx *c, zval **return_value,
-				  long flags, long time_limit, size_t memory_limit,
+				  long flags, long time_limit, size_t memory_limit, const char *identifier,
 				  std::function< v8::MaybeLocal<v8::Value>(v8::Isolate *) >& v8_call);
 void v8js_terminate_execution(v8::Isolate *isolate);
 
@@ -67,6 +82,12 @@ int v8js_get_properties_hash(v8::Local<v8::Value> jsValue, HashTable *retval, in
 		return ret; \
 	} \
 	\
+	/* V8 checks its stack limit against the thread's stack, not a Fiber's */ \
+	if (V8JSG(in_async_fiber)) { \
+		zend_throw_exception(php_ce_v8js_exception, "Cannot call into V8 from the Fiber of an async callback", 0); \
+		return ret; \
+	} \
+	\
 	v8::Isolate *isolate = (ctx)->isolate; \
 	v8::Locker locker(isolate); \
 	v8::Isolate::Scope isolate_scope(isolate); \
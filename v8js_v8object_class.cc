@@ -18,6 +18,7 @@
 
 #include "php_v8js_macros.h"
 #include "v8js_exceptions.h"
+#include "v8js_memoize.h"
 #include "v8js_v8.h"
 #include "v8js_v8object_class.h"
 
@@ -291,6 +292,28 @@ static HashTable *v8js_v8object_get_debug_info(zend_object *object, int *is_temp
 }
 /* }}} */
 
+/* Memo id of the wrapped function, read on every call (not cached in the
+ * wrapper), so all wrappers see memoize() calls made through any of them */
+static int v8js_v8object_memo_id(v8js_v8object *obj) /* {{{ */
+{
+	if (!obj->ctx->memo_next_id)
+	{
+		/* Nothing memoized so far, don't even enter V8 */
+		return 0;
+	}
+
+	V8JS_CTX_PROLOGUE_EX(obj->ctx, 0);
+	v8::Local<v8::Value> v8obj = v8::Local<v8::Value>::New(isolate, obj->v8obj);
+
+	if (!v8obj->IsFunction())
+	{
+		return 0;
+	}
+
+	return v8js_memoize_id(obj->ctx, v8::Local<v8::Function>::Cast(v8obj));
+}
+/* }}} */
+
 static ZEND_FUNCTION(zend_v8object_func)
 {
 	RETVAL_STR_COPY(EX(func)->common.function_name);
@@ -342,65 +365,79 @@ static ZEND_FUNCTION(zend_v8object_func)
 	/* std::function relies on its dtor to be executed, otherwise it leaks
 	 * some memory on bailout. */
 	{
-		std::function<v8::MaybeLocal<v8::Value>(v8::Isolate *)> v8_call = [obj, method, argc, argv, object, &return_value](v8::Isolate *isolate)
+		/* Memoized functions are only invoked if there's no cached result
+		 * for structurally equal arguments. */
+		std::string memo_key;
+		int memo_id = v8js_v8object_memo_id(obj);
+		bool memoize = memo_id && v8js_memoize_key(memo_id, obj->flags, argv, argc, memo_key);
+
+		if (!memoize || !v8js_memoize_lookup(obj->ctx, memo_key, return_value))
 		{
-			int i = 0;
+			std::function<v8::MaybeLocal<v8::Value>(v8::Isolate *)> v8_call = [obj, method, argc, argv, object, &return_value](v8::Isolate *isolate)
+			{
+				int i = 0;
 
-			v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
-			v8::Local<v8::String> method_name = V8JS_SYML(ZSTR_VAL(method), static_cast<int>(ZSTR_LEN(method)));
-			v8::Local<v8::Object> v8obj = v8::Local<v8::Value>::New(isolate, obj->v8obj)->ToObject(v8_context).ToLocalChecked();
-			v8::Local<v8::Object> thisObj;
-			v8::Local<v8::Function> cb;
+				v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
+				v8::Local<v8::String> method_name = V8JS_SYML(ZSTR_VAL(method), static_cast<int>(ZSTR_LEN(method)));
+				v8::Local<v8::Object> v8obj = v8::Local<v8::Value>::New(isolate, obj->v8obj)->ToObject(v8_context).ToLocalChecked();
+				v8::Local<v8::Object> thisObj;
+				v8::Local<v8::Function> cb;
 
-			if (method_name->Equals(v8_context, V8JS_SYM(V8JS_V8_INVOKE_FUNC_NAME)).FromMaybe(false))
-			{
-				cb = v8::Local<v8::Function>::Cast(v8obj);
-			}
-			else
-			{
-				v8::Local<v8::Value> slot;
+				if (method_name->Equals(v8_context, V8JS_SYM(V8JS_V8_INVOKE_FUNC_NAME)).FromMaybe(false))
+				{
+					cb = v8::Local<v8::Function>::Cast(v8obj);
+				}
+				else
+				{
+					v8::Local<v8::Value> slot;
+
+					if (!v8obj->Get(v8_context, method_name).ToLocal(&slot))
+					{
+						return v8::MaybeLocal<v8::Value>();
+					}
+
+					cb = v8::Local<v8::Function>::Cast(slot);
+				}
 
-				if (!v8obj->Get(v8_context, method_name).ToLocal(&slot))
+				// If a method is invoked on V8Object, then set the object itself as
+				// "this" on JS side.  Otherwise fall back to global object.
+				if (obj->std.ce == php_ce_v8object)
 				{
-					return v8::MaybeLocal<v8::Value>();
+					thisObj = v8obj;
+				}
+				else
+				{
+					thisObj = V8JS_GLOBAL(isolate);
 				}
 
-				cb = v8::Local<v8::Function>::Cast(slot);
-			}
+				v8::Local<v8::Value> *jsArgv = static_cast<v8::Local<v8::Value> *>(alloca(sizeof(v8::Local<v8::Value>) * argc));
 
-			// If a method is invoked on V8Object, then set the object itself as
-			// "this" on JS side.  Otherwise fall back to global object.
-			if (obj->std.ce == php_ce_v8object)
-			{
-				thisObj = v8obj;
-			}
-			else
-			{
-				thisObj = V8JS_GLOBAL(isolate);
-			}
+				for (i = 0; i < argc; i++)
+				{
+					new (&jsArgv[i]) v8::Local<v8::Value>;
+					jsArgv[i] = v8::Local<v8::Value>::New(isolate, zval_to_v8js(&argv[i], isolate));
+				}
 
-			v8::Local<v8::Value> *jsArgv = static_cast<v8::Local<v8::Value> *>(alloca(sizeof(v8::Local<v8::Value>) * argc));
+				v8::MaybeLocal<v8::Value> result = cb->Call(v8_context, thisObj, argc, jsArgv);
 
-			for (i = 0; i < argc; i++)
-			{
-				new (&jsArgv[i]) v8::Local<v8::Value>;
-				jsArgv[i] = v8::Local<v8::Value>::New(isolate, zval_to_v8js(&argv[i], isolate));
-			}
+				if (obj->std.ce == php_ce_v8object && !result.IsEmpty() && result.ToLocalChecked()->StrictEquals(thisObj))
+				{
+					/* JS code did "return this", retain object identity */
+					ZVAL_OBJ(return_value, object);
+					zval_copy_ctor(return_value);
+					result = v8::MaybeLocal<v8::Value>();
+				}
+
+				return result;
+			};
 
-			v8::MaybeLocal<v8::Value> result = cb->Call(v8_context, thisObj, argc, jsArgv);
+			v8js_v8_call(obj->ctx, &return_value, obj->flags, obj->ctx->time_limit, obj->ctx->memory_limit, ZSTR_VAL(method), v8_call);
 
-			if (obj->std.ce == php_ce_v8object && !result.IsEmpty() && result.ToLocalChecked()->StrictEquals(thisObj))
+			if (memoize && !EG(exception) && !V8JSG(fatal_error_abort))
 			{
-				/* JS code did "return this", retain object identity */
-				ZVAL_OBJ(return_value, object);
-				zval_copy_ctor(return_value);
-				result = v8::MaybeLocal<v8::Value>();
+				v8js_memoize_store(obj->ctx, memo_key, return_value);
 			}
-
-			return result;
-		};
-
-		v8js_v8_call(obj->ctx, &return_value, obj->flags, obj->ctx->time_limit, obj->ctx->memory_limit, v8_call);
+		}
 	}
 
 	if (argc > 0)
@@ -432,6 +469,13 @@ static zend_function *v8js_v8object_get_method(zend_object **object_ptr, zend_st
 		return NULL;
 	}
 
+	if ((*object_ptr)->ce == php_ce_v8function)
+	{
+		/* JS functions expose no methods besides __invoke (see get_closure),
+		 * but V8Function's own methods */
+		return std_object_handlers.get_method(object_ptr, method, key);
+	}
+
 	if (ZSTR_LEN(method) > std::numeric_limits<int>::max())
 	{
 		zend_throw_exception(php_ce_v8js_exception,
@@ -460,7 +504,8 @@ static zend_function *v8js_v8object_get_method(zend_object **object_ptr, zend_st
 		}
 	}
 
-	return NULL;
+	/* V8Object's own methods (extract, assign), unless shadowed by JS */
+	return std_object_handlers.get_method(object_ptr, method, key);
 }
 /* }}} */
 
@@ -476,12 +521,17 @@ static int v8js_v8object_get_closure(zend_object *object, zend_class_entry **ce_
 		return FAILURE;
 	}
 
-	V8JS_CTX_PROLOGUE_EX(obj->ctx, FAILURE);
-	v8::Local<v8::Value> v8obj = v8::Local<v8::Value>::New(isolate, obj->v8obj);
-
-	if (!v8obj->IsFunction())
+	/* V8 can't be entered from the Fiber of an async callback, let the call
+	 * itself throw the V8JsException (instead of "not callable") then */
+	if (!V8JSG(in_async_fiber))
 	{
-		return FAILURE;
+		V8JS_CTX_PROLOGUE_EX(obj->ctx, FAILURE);
+		v8::Local<v8::Value> v8obj = v8::Local<v8::Value>::New(isolate, obj->v8obj);
+
+		if (!v8obj->IsFunction())
+		{
+			return FAILURE;
+		}
 	}
 
 	invoke = (zend_internal_function *)ecalloc(1, sizeof(*invoke));
@@ -602,6 +652,195 @@ PHP_METHOD(V8Function, __wakeup)
 }
 /* }}} */
 
+/* {{{ proto array V8Object::extract(array paths [, int flags])
+ */
+PHP_METHOD(V8Object, extract)
+{
+	HashTable *paths;
+	zend_long flags = 0;
+	bool flags_is_null = 1;
+	zval *path;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "h|l!", &paths, &flags, &flags_is_null) == FAILURE)
+	{
+		return;
+	}
+
+	v8js_v8object *obj = Z_V8JS_V8OBJECT_OBJ_P(getThis());
+
+	if (!obj->ctx)
+	{
+		zend_throw_exception(php_ce_v8js_exception,
+							 "Can't access V8Object after V8Js instance is destroyed!", 0);
+		return;
+	}
+
+	if (flags_is_null)
+	{
+		flags = obj->flags;
+	}
+
+	array_init_size(return_value, zend_hash_num_elements(paths));
+
+	V8JS_CTX_PROLOGUE(obj->ctx);
+	v8::TryCatch try_catch(isolate);
+	v8::Local<v8::Value> root = v8::Local<v8::Value>::New(isolate, obj->v8obj);
+
+	/* Values of already resolved (sub)paths, so common prefixes are looked up once */
+	std::unordered_map<std::string, v8::Local<v8::Value>> resolved;
+
+	ZEND_HASH_FOREACH_VAL(paths, path)
+	{
+		zend_string *path_str = zval_get_string(path);
+		const char *p = ZSTR_VAL(path_str), *end = p + ZSTR_LEN(path_str);
+		v8::Local<v8::Value> value = root;
+		zval zv;
+
+		while (p < end && !value.IsEmpty())
+		{
+			const char *dot = static_cast<const char *>(memchr(p, '.', end - p));
+			const char *segment_end = dot ? dot : end;
+			std::string prefix(ZSTR_VAL(path_str), segment_end - ZSTR_VAL(path_str));
+			std::unordered_map<std::string, v8::Local<v8::Value>>::iterator it = resolved.find(prefix);
+
+			if (it != resolved.end())
+			{
+				value = it->second;
+			}
+			else if (value->IsObject())
+			{
+				v8::Local<v8::Object> jsObj = value.As<v8::Object>();
+				v8::Local<v8::String> jsKey = V8JS_SYML(p, static_cast<int>(segment_end - p));
+
+				if (!jsObj->Get(v8_context, jsKey).ToLocal(&value))
+				{
+					/* Getter threw */
+					zend_string_release(path_str);
+					zval_ptr_dtor(return_value);
+					v8js_throw_script_exception(isolate, &try_catch);
+					RETURN_NULL();
+				}
+
+				resolved[prefix] = value;
+			}
+			else
+			{
+				value = v8::Local<v8::Value>();
+			}
+
+			p = segment_end + 1;
+		}
+
+		if (value.IsEmpty() || v8js_to_zval(value, &zv, flags, isolate) == FAILURE)
+		{
+			ZVAL_NULL(&zv);
+		}
+
+		zend_symtable_update(Z_ARRVAL_P(return_value), path_str, &zv);
+		zend_string_release(path_str);
+	}
+	ZEND_HASH_FOREACH_END();
+}
+/* }}} */
+
+/* {{{ proto V8Object V8Object::assign(array values)
+ */
+PHP_METHOD(V8Object, assign)
+{
+	HashTable *values;
+	zend_string *key;
+	zend_ulong index;
+	zval *value;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "h", &values) == FAILURE)
+	{
+		return;
+	}
+
+	v8js_v8object *obj = Z_V8JS_V8OBJECT_OBJ_P(getThis());
+
+	if (!obj->ctx)
+	{
+		zend_throw_exception(php_ce_v8js_exception,
+							 "Can't access V8Object after V8Js instance is destroyed!", 0);
+		return;
+	}
+
+	{
+		V8JS_CTX_PROLOGUE(obj->ctx);
+		v8::Local<v8::Value> v8objHandle = v8::Local<v8::Value>::New(isolate, obj->v8obj);
+		v8::Local<v8::Object> v8obj;
+
+		if (v8objHandle->IsObject() && v8objHandle->ToObject(v8_context).ToLocal(&v8obj))
+		{
+			ZEND_HASH_FOREACH_KEY_VAL(values, index, key, value)
+			{
+				v8::Local<v8::Value> js_value = zval_to_v8js(value, isolate);
+
+				if (key)
+				{
+					if (ZSTR_LEN(key) > std::numeric_limits<int>::max())
+					{
+						zend_throw_exception(php_ce_v8js_exception,
+											 "Member name length exceeds maximum supported length", 0);
+						return;
+					}
+
+					v8obj->CreateDataProperty(v8_context, V8JS_ZSYM(key), js_value);
+				}
+				else if (index < std::numeric_limits<uint32_t>::max())
+				{
+					v8obj->CreateDataProperty(v8_context, static_cast<uint32_t>(index), js_value);
+				}
+				else
+				{
+					/* Not an array index (e.g. negative), use its string form */
+					zend_string *key_str = zend_long_to_str(static_cast<zend_long>(index));
+					v8obj->CreateDataProperty(v8_context, V8JS_ZSYM(key_str), js_value);
+					zend_string_release(key_str);
+				}
+			}
+			ZEND_HASH_FOREACH_END();
+		}
+	}
+
+	RETURN_OBJ_COPY(Z_OBJ_P(getThis()));
+}
+/* }}} */
+
+/* {{{ proto V8Function V8Function::memoize([bool enable = true])
+ */
+PHP_METHOD(V8Function, memoize)
+{
+	bool enable = true;
+
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "|b", &enable) == FAILURE)
+	{
+		return;
+	}
+
+	v8js_v8object *obj = Z_V8JS_V8OBJECT_OBJ_P(getThis());
+
+	if (!obj->ctx)
+	{
+		zend_throw_exception(php_ce_v8js_exception,
+							 "Can't access V8Object after V8Js instance is destroyed!", 0);
+		return;
+	}
+
+	{
+		V8JS_CTX_PROLOGUE(obj->ctx);
+		v8::Local<v8::Value> v8obj = v8::Local<v8::Value>::New(isolate, obj->v8obj);
+
+		/* The mark is stored on the JS function, so other V8Function
+		 * instances wrapping it (and the cached results) are shared. */
+		v8js_memoize_mark(obj->ctx, v8::Local<v8::Function>::Cast(v8obj), enable);
+	}
+
+	RETURN_OBJ_COPY(Z_OBJ_P(getThis()));
+}
+/* }}} */
+
 static void v8js_v8generator_free_storage(zend_object *object) /* {{{ */
 {
 	v8js_v8generator *c = v8js_v8generator_fetch_object(object);
@@ -671,7 +910,7 @@ static void v8js_v8generator_next(v8js_v8generator *g) /* {{{ */
 			return V8JS_NULL;
 		};
 
-		v8js_v8_call(g->v8obj.ctx, NULL, g->v8obj.flags, g->v8obj.ctx->time_limit, g->v8obj.ctx->memory_limit, v8_call);
+		v8js_v8_call(g->v8obj.ctx, NULL, g->v8obj.flags, g->v8obj.ctx->time_limit, g->v8obj.ctx->memory_limit, "V8Generator::next", v8_call);
 	}
 
 	if (V8JSG(fatal_error_abort))
@@ -825,10 +1064,21 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_INFO(arginfo_v8object_wakeup, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8object_extract, 0, 0, 1)
+ZEND_ARG_ARRAY_INFO(0, paths, 0)
+ZEND_ARG_INFO(0, flags)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8object_assign, 0, 0, 1)
+ZEND_ARG_ARRAY_INFO(0, values, 0)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry v8js_v8object_methods[] = {/* {{{ */
 															PHP_ME(V8Object, __construct, arginfo_v8object_construct, ZEND_ACC_PUBLIC | ZEND_ACC_CTOR)
 																PHP_ME(V8Object, __sleep, arginfo_v8object_sleep, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
-																	PHP_ME(V8Object, __wakeup, arginfo_v8object_wakeup, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL){NULL, NULL, NULL}};
+																	PHP_ME(V8Object, __wakeup, arginfo_v8object_wakeup, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+																		PHP_ME(V8Object, extract, arginfo_v8object_extract, ZEND_ACC_PUBLIC)
+																			PHP_ME(V8Object, assign, arginfo_v8object_assign, ZEND_ACC_PUBLIC){NULL, NULL, NULL}};
 /* }}} */
 
 ZEND_BEGIN_ARG_INFO(arginfo_v8function_construct, 0)
@@ -840,10 +1090,15 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_INFO(arginfo_v8function_wakeup, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(arginfo_v8function_memoize, 0, 0, 0)
+ZEND_ARG_INFO(0, enable)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry v8js_v8function_methods[] = {/* {{{ */
 															  PHP_ME(V8Function, __construct, arginfo_v8function_construct, ZEND_ACC_PUBLIC | ZEND_ACC_CTOR)
 																  PHP_ME(V8Function, __sleep, arginfo_v8function_sleep, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
-																	  PHP_ME(V8Function, __wakeup, arginfo_v8function_wakeup, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL){NULL, NULL, NULL}};
+																	  PHP_ME(V8Function, __wakeup, arginfo_v8function_wakeup, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+																		  PHP_ME(V8Function, memoize, arginfo_v8function_memoize, ZEND_ACC_PUBLIC){NULL, NULL, NULL}};
 /* }}} */
 
 ZEND_BEGIN_ARG_INFO(arginfo_v8generator_construct, 0)
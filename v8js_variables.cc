@@ -88,6 +88,140 @@ void v8js_register_accessors(std::vector<v8js_accessor_ctx*> *accessor_list, v8:
 }
 /* }}} */
 
+/* Whether value still is the one converted last, PHP separates arrays and
+ * strings on write as the snapshot holds a reference to them */
+static bool v8js_binding_unchanged(zval *snapshot, zval *value) /* {{{ */
+{
+	if (Z_TYPE_P(snapshot) != Z_TYPE_P(value)) {
+		return false;
+	}
+
+	switch (Z_TYPE_P(value)) {
+		case IS_LONG:
+			return Z_LVAL_P(snapshot) == Z_LVAL_P(value);
+
+		case IS_DOUBLE:
+			return memcmp(&Z_DVAL_P(snapshot), &Z_DVAL_P(value), sizeof(double)) == 0;
+
+		case IS_STRING:
+			return Z_STR_P(snapshot) == Z_STR_P(value);
+
+		case IS_ARRAY:
+			return Z_ARR_P(snapshot) == Z_ARR_P(value);
+
+		case IS_OBJECT:
+			/* wrapped objects are live-bound anyways */
+			return Z_OBJ_P(snapshot) == Z_OBJ_P(value);
+
+		default:
+			/* null, true, false */
+			return true;
+	}
+}
+/* }}} */
+
+static void v8js_fetch_global_binding(v8::Local<v8::Name> name, const v8::PropertyCallbackInfo<v8::Value>& info) /* {{{ */
+{
+	v8::Isolate *isolate = info.GetIsolate();
+	v8js_global_binding *binding = static_cast<v8js_global_binding *>(info.Data().As<v8::External>()->Value());
+	zval *value = &binding->ref->val;
+
+	if (binding->mode == V8JS_BIND_REFERENCE) {
+		info.GetReturnValue().Set(zval_to_v8js(value, isolate));
+		return;
+	}
+
+	if (binding->cached.IsEmpty() || !v8js_binding_unchanged(&binding->snapshot, value)) {
+		zval_ptr_dtor(&binding->snapshot);
+		ZVAL_COPY(&binding->snapshot, value);
+		binding->cached.Reset(isolate, zval_to_v8js(value, isolate));
+	}
+
+	info.GetReturnValue().Set(v8::Local<v8::Value>::New(isolate, binding->cached));
+}
+/* }}} */
+
+void v8js_global_binding_dtor(v8js_global_binding *binding) /* {{{ */
+{
+	binding->cached.Reset();
+	zval_ptr_dtor(&binding->snapshot);
+
+	zval ref;
+	ZVAL_REF(&ref, binding->ref);
+	zval_ptr_dtor(&ref);
+
+	delete binding;
+}
+/* }}} */
+
+bool v8js_bind_globals(v8js_ctx *c, HashTable *values, int mode, v8::Isolate *isolate) /* {{{ */
+{
+	v8::Local<v8::Context> v8_context = isolate->GetEnteredOrMicrotaskContext();
+	v8::Local<v8::Object> global = v8_context->Global();
+	zend_string *name;
+	zval *item;
+
+	if (mode != V8JS_BIND_COPY && mode != V8JS_BIND_REFERENCE && mode != V8JS_BIND_TRACKED) {
+		zend_throw_exception(php_ce_v8js_exception, "Invalid binding mode", 0);
+		return false;
+	}
+
+	/* Validate all entries first, so nothing is bound if one of them is invalid */
+	ZEND_HASH_FOREACH_STR_KEY_VAL(values, name, item) {
+		if (!name) {
+			zend_throw_exception(php_ce_v8js_exception, "Global binding names must be strings", 0);
+			return false;
+		}
+
+		if (ZSTR_LEN(name) > std::numeric_limits<int>::max()) {
+			zend_throw_exception(php_ce_v8js_exception,
+				"Property name length exceeds maximum supported length", 0);
+			return false;
+		}
+
+		if (mode != V8JS_BIND_COPY && Z_TYPE_P(item) != IS_REFERENCE) {
+			zend_throw_exception_ex(php_ce_v8js_exception, 0,
+				"Global binding '%s' must be passed by reference", ZSTR_VAL(name));
+			return false;
+		}
+	} ZEND_HASH_FOREACH_END();
+
+	ZEND_HASH_FOREACH_STR_KEY_VAL(values, name, item) {
+		v8::Local<v8::Name> key = V8JS_ZSYM(name);
+		std::string binding_name(ZSTR_VAL(name), ZSTR_LEN(name));
+
+		global->Delete(v8_context, key);
+
+		/* The accessor is gone, release the binding it referred to */
+		std::map<std::string, v8js_global_binding *>::iterator it = c->global_bindings.find(binding_name);
+
+		if (it != c->global_bindings.end()) {
+			v8js_global_binding_dtor(it->second);
+			c->global_bindings.erase(it);
+		}
+
+		if (mode == V8JS_BIND_COPY) {
+			global->DefineOwnProperty(v8_context, key, zval_to_v8js(item, isolate), v8::ReadOnly);
+			continue;
+		}
+
+		v8js_global_binding *binding = new v8js_global_binding();
+		binding->mode = mode;
+		binding->ref = Z_REF_P(item);
+		GC_ADDREF(binding->ref);
+		ZVAL_UNDEF(&binding->snapshot);
+
+		global->SetAccessor(v8_context, key, v8js_fetch_global_binding, NULL,
+			v8::External::New(isolate, binding), v8::DEFAULT, v8::ReadOnly);
+
+		/* record the binding so we can free it later (or once it's replaced) */
+		c->global_bindings[binding_name] = binding;
+	} ZEND_HASH_FOREACH_END();
+
+	return true;
+}
+/* }}} */
+
 /*
  * Local variables:
  * tab-width: 4